@@ -0,0 +1,80 @@
+#ifndef EDYN_TESTBED_ADAPTIVE_GRAIN_HPP
+#define EDYN_TESTBED_ADAPTIVE_GRAIN_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * Picks the grain size of parallel-for ranges based on how long previous
+ * ranges of similar size took to execute. Ranges are bucketed by the bit
+ * width of their size, thus a task of size 300 and one of size 400 share
+ * the same grain. The grain converges to a value that makes each chunk
+ * run for roughly `m_target_chunk_time` while still leaving enough chunks
+ * for all workers to stay busy.
+ */
+class AdaptiveGrainController {
+public:
+    using clock = std::chrono::steady_clock;
+
+    // One measurement in progress. Workers accumulate the time spent in
+    // their chunks in `busy_ns` and the owner reports it when done.
+    struct Sample {
+        unsigned size;
+        unsigned grain;
+        clock::time_point start;
+        std::atomic<int64_t> busy_ns {0};
+
+        void addBusyTime(clock::time_point chunk_start) {
+            auto elapsed = clock::now() - chunk_start;
+            busy_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        }
+    };
+
+    struct Stats {
+        unsigned max_size;
+        unsigned grain;
+        double cost_per_item_ns;
+        double utilization;
+        uint64_t num_dispatches;
+    };
+
+    AdaptiveGrainController(unsigned num_workers);
+
+    unsigned grain(unsigned size);
+    void begin(Sample &sample, unsigned size);
+    void end(const Sample &sample);
+    std::vector<Stats> stats() const;
+
+    // Desired execution time of a single chunk. Large enough to amortize the
+    // dispatch overhead, small enough to balance uneven ranges.
+    double m_target_chunk_time {50e-6};
+    // Minimum number of chunks per worker for load balancing.
+    unsigned m_min_chunks_per_worker {4};
+    // Weight of the newest measurement in the moving averages.
+    double m_smoothing {0.2};
+
+private:
+    struct Bucket {
+        unsigned grain {1};
+        double cost_per_item {0};
+        double utilization {0};
+        uint64_t num_dispatches {0};
+    };
+
+    static constexpr size_t num_buckets = 33;
+
+    static size_t bucketIndex(unsigned size);
+    unsigned maxGrain(unsigned size) const;
+
+    unsigned m_num_workers;
+    std::array<Bucket, num_buckets> m_buckets;
+    mutable std::mutex m_mutex;
+};
+
+void showGrainProfiling(const char *label, const AdaptiveGrainController &);
+
+#endif // EDYN_TESTBED_ADAPTIVE_GRAIN_HPP
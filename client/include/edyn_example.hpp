@@ -17,6 +17,9 @@
 #include <entt/entity/entity.hpp>
 
 #include "debugdraw.hpp"
+#include "rewind_buffer.hpp"
+#include "scene_builder.hpp"
+#include "world_snapshot.hpp"
 
 #ifdef EDYN_SOUND_ENABLED
 #include <soloud.h>
@@ -71,18 +74,32 @@ public:
     virtual void updatePhysics(float deltaTime);
     void togglePausePhysics();
     void stepPhysics();
+    void stepBackPhysics();
     void setPaused(bool);
+    void updateSceneBuilder();
+    void resetScene();
+    // Whether `resetScene` restores the snapshot taken once the scene is
+    // built. Snapshots only hold rigid bodies, thus examples which create or
+    // destroy bodies at runtime along with constraints, components or state
+    // referring to them must opt out and rebuild that in `onSceneReset`, if
+    // they support resetting at all.
+    virtual bool canRestoreSnapshot() const { return true; }
+    virtual void onSceneReset() {}
     void updateGUI();
     void updatePicking(float viewMtx[16], float proj[16]);
     void processRaycast(const edyn::raycast_result &, edyn::vector3 p0, edyn::vector3 p1);
     void onRaycastResult(edyn::raycast_id_type, const edyn::raycast_result &,
                          edyn::vector3, edyn::vector3);
     void showSettings();
+    virtual void showCustomSettings() {}
     void showProfiling();
+    virtual void showCustomProfiling() {}
     void showFooter();
+    void showSceneProgress();
     void updateSettings();
 
     void drawRaycast(DebugDrawEncoder &dde);
+    virtual void drawCustom(DebugDrawEncoder &dde) {}
 
     entry::MouseState m_mouseState;
 
@@ -100,7 +117,7 @@ public:
     int m_num_position_iterations;
     float m_gui_gravity;
     edyn::scalar m_gravity;
-    bool m_pause;
+    bool m_pause {false};
 
     std::unique_ptr<entt::registry> m_registry;
     entt::entity m_pick_entity {entt::null};
@@ -111,8 +128,20 @@ public:
     edyn::scalar m_rigid_body_axes_size {0.15f};
     bool m_proportional_pick_stiffness {true};
 
+    // Examples with heavy assets add stages to it in `createScene` instead
+    // of building everything right away. Physics is paused until the static
+    // world is ready.
+    SceneBuilder m_scene_builder;
+    double m_scene_build_budget {0.008};
+
+    // State of the world once the scene is built, restored by `resetScene`.
+    WorldSnapshot m_initial_snapshot;
+
+    // Timestamp of the simulation state last recorded for rewinding.
+    double m_rewind_record_timestamp {};
+
 	std::string m_footer_text;
-	std::string m_default_footer_text {"Press 'P' to pause and 'L' to step simulation while paused."};
+	std::string m_default_footer_text {"Press 'P' to pause, 'L' and 'K' to step forward and back while paused and 'R' to reset."};
 
 #ifdef EDYN_SOUND_ENABLED
     SoLoud::Soloud m_soloud;
@@ -33,6 +33,9 @@ public:
 
     void updatePhysics(float deltaTime) override;
 
+    // Bodies come from the server, which restarts the map by itself.
+    bool canRestoreSnapshot() const override { return false; }
+
 private:
     ENetHost *m_host {nullptr};
     ENetPeer *m_peer {nullptr};
@@ -0,0 +1,120 @@
+#include "adaptive_grain.hpp"
+#include <algorithm>
+#include <cmath>
+#include <dear-imgui/imgui.h>
+
+AdaptiveGrainController::AdaptiveGrainController(unsigned num_workers)
+    : m_num_workers(std::max(num_workers, 1u))
+{}
+
+size_t AdaptiveGrainController::bucketIndex(unsigned size) {
+    size_t index = 0;
+
+    while (size > 0) {
+        size >>= 1;
+        ++index;
+    }
+
+    return index;
+}
+
+unsigned AdaptiveGrainController::maxGrain(unsigned size) const {
+    auto num_chunks = m_num_workers * m_min_chunks_per_worker;
+    return std::max(size / num_chunks, 1u);
+}
+
+unsigned AdaptiveGrainController::grain(unsigned size) {
+    std::lock_guard lock(m_mutex);
+    auto &bucket = m_buckets[bucketIndex(size)];
+
+    // Start with one chunk per worker for sizes never seen before, which
+    // matches the static choice this replaces.
+    if (bucket.num_dispatches == 0) {
+        bucket.grain = std::max(size / m_num_workers, 1u);
+    }
+
+    return std::clamp(bucket.grain, 1u, std::max(size, 1u));
+}
+
+void AdaptiveGrainController::begin(Sample &sample, unsigned size) {
+    sample.size = size;
+    sample.grain = grain(size);
+    sample.start = clock::now();
+    sample.busy_ns = 0;
+}
+
+void AdaptiveGrainController::end(const Sample &sample) {
+    if (sample.size == 0) {
+        return;
+    }
+
+    auto wall = std::chrono::duration<double>(clock::now() - sample.start).count();
+    auto busy = double(sample.busy_ns.load()) * 1e-9;
+
+    std::lock_guard lock(m_mutex);
+    auto &bucket = m_buckets[bucketIndex(sample.size)];
+    auto cost_per_item = busy / sample.size;
+    auto utilization = wall > 0 ? std::min(busy / (wall * m_num_workers), 1.0) : 0.0;
+
+    if (bucket.num_dispatches == 0) {
+        bucket.cost_per_item = cost_per_item;
+        bucket.utilization = utilization;
+    } else {
+        bucket.cost_per_item += (cost_per_item - bucket.cost_per_item) * m_smoothing;
+        bucket.utilization += (utilization - bucket.utilization) * m_smoothing;
+    }
+
+    ++bucket.num_dispatches;
+
+    // Grain that would make each chunk take the target time, limited so
+    // there are enough chunks to go around.
+    auto target = bucket.cost_per_item > 0 ?
+        m_target_chunk_time / bucket.cost_per_item : double(sample.size);
+    target = std::clamp(target, 1.0, double(maxGrain(sample.size)));
+
+    // Move geometrically towards the target to avoid oscillating due to
+    // noisy measurements.
+    auto current = double(std::max(bucket.grain, 1u));
+    auto next = current * std::pow(target / current, m_smoothing);
+    bucket.grain = std::max(static_cast<unsigned>(std::lround(next)), 1u);
+}
+
+std::vector<AdaptiveGrainController::Stats> AdaptiveGrainController::stats() const {
+    std::lock_guard lock(m_mutex);
+    auto result = std::vector<Stats>{};
+
+    for (size_t i = 0; i < num_buckets; ++i) {
+        auto &bucket = m_buckets[i];
+
+        if (bucket.num_dispatches == 0) {
+            continue;
+        }
+
+        auto max_size = i == 0 ? 0u : static_cast<unsigned>((uint64_t(1) << i) - 1);
+        result.push_back({max_size, bucket.grain, bucket.cost_per_item * 1e9,
+                          bucket.utilization, bucket.num_dispatches});
+    }
+
+    return result;
+}
+
+void showGrainProfiling(const char *label, const AdaptiveGrainController &controller) {
+    if (!ImGui::CollapsingHeader(label, ImGuiTreeNodeFlags_DefaultOpen)) {
+        return;
+    }
+
+    ImGui::Columns(4);
+    ImGui::Text("Size <=");    ImGui::NextColumn();
+    ImGui::Text("Grain");      ImGui::NextColumn();
+    ImGui::Text("ns/item");    ImGui::NextColumn();
+    ImGui::Text("Busy %%");    ImGui::NextColumn();
+
+    for (auto &stats : controller.stats()) {
+        ImGui::Text("%u", stats.max_size);                  ImGui::NextColumn();
+        ImGui::Text("%u", stats.grain);                     ImGui::NextColumn();
+        ImGui::Text("%.1f", stats.cost_per_item_ns);        ImGui::NextColumn();
+        ImGui::Text("%.0f", stats.utilization * 100);       ImGui::NextColumn();
+    }
+
+    ImGui::Columns(1);
+}
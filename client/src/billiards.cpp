@@ -1,8 +1,6 @@
 #include "edyn_example.hpp"
-#include <edyn/collision/contact_manifold.hpp>
-#include <edyn/collision/contact_point.hpp>
-#include <edyn/comp/tag.hpp>
-#include <iostream>
+#include "async_log.hpp"
+#include "contact_events.hpp"
 
 #ifdef EDYN_SOUND_ENABLED
 #include <soloud_wav.h>
@@ -132,33 +130,38 @@ public:
         m_ball_table_collision_sound.load("../../../edyn-testbed/resources/332661__reitanna__big-thud.wav");
         m_ball_table_collision_sound.set3dMinMaxDistance(0, 30);
 
-        // Register contact event handlers.
-        m_registry->on_construct<edyn::contact_started_tag>().connect<&ExampleBilliards::contactStarted>(*this);
+        EnableContactEvents(*m_registry);
 #endif
     }
 
 #ifdef EDYN_SOUND_ENABLED
-    void contactStarted(entt::registry &registry, entt::entity contact_entity) {
-        auto &cp_list = registry.get<edyn::contact_point_list>(contact_entity);
-        auto &manifold = registry.get<edyn::contact_manifold>(cp_list.parent);
-        auto &materialA = registry.get<edyn::material>(manifold.body[0]);
-        auto &materialB = registry.get<edyn::material>(manifold.body[1]);
+    void destroyScene() override {
+        DisableContactEvents(*m_registry);
+    }
 
-        auto is_ball_ball = materialA.id == m_ball_mat_id && materialB.id == m_ball_mat_id;
-        auto is_ball_table =
-        (materialA.id == m_ball_mat_id && (materialB.id == m_table_mat_id || materialB.id == m_rail_mat_id)) ||
-        (materialB.id == m_ball_mat_id && (materialA.id == m_table_mat_id || materialA.id == m_rail_mat_id));
+    void updatePhysics(float deltaTime) override {
+        EdynExample::updatePhysics(deltaTime);
 
-        auto &posA = registry.get<edyn::position>(manifold.body[0]);
-        auto &ornA = registry.get<edyn::orientation>(manifold.body[0]);
+        for (auto &event : PollContactEvents(*m_registry)) {
+            if (event.type == ContactEventType::Started) {
+                contactStarted(event);
+            }
+        }
+    }
+
+    void contactStarted(const ContactEvent &event) {
+        auto materialA = event.material_id[0];
+        auto materialB = event.material_id[1];
 
-        auto &cp_imp = registry.get<edyn::contact_point_impulse>(contact_entity);
-        float normal_impulse = cp_imp.normal_impulse + cp_imp.normal_restitution_impulse;
+        auto is_ball_ball = materialA == m_ball_mat_id && materialB == m_ball_mat_id;
+        auto is_ball_table =
+        (materialA == m_ball_mat_id && (materialB == m_table_mat_id || materialB == m_rail_mat_id)) ||
+        (materialB == m_ball_mat_id && (materialA == m_table_mat_id || materialA == m_rail_mat_id));
 
-        auto &cp = registry.get<edyn::contact_point>(contact_entity);
-        edyn::vector3 pos_cp = edyn::to_world_space(cp.pivotA, posA, ornA);
+        float normal_impulse = event.normal_impulse;
+        auto &pos_cp = event.point;
 
-        std::cout << "Started | impulse: " << normal_impulse << std::endl;
+        Log(m_contact_log_limiter, "Started | impulse: %f", normal_impulse);
 
         if (is_ball_ball) {
             auto volume = normal_impulse * 20.f;
@@ -181,6 +184,7 @@ public:
     const edyn::material::id_type m_rail_mat_id = 2;
 
 #ifdef EDYN_SOUND_ENABLED
+    LogRateLimiter m_contact_log_limiter {20, 40};
     SoLoud::Wav m_ball_ball_collision_sound;
     SoLoud::Wav m_ball_table_collision_sound;
 #endif
@@ -1,4 +1,5 @@
 #include "edyn_example.hpp"
+#include "rigidbody_batch.hpp"
 
 class ExampleBoxes : public EdynExample
 {
@@ -28,17 +29,19 @@ public:
         def.material->restitution = 0;
         def.shape = edyn::box_shape{0.2, 0.2, 0.2};
         const auto n = 5;
+        auto positions = std::vector<edyn::vector3>{};
 
         for (int i = 0; i < n; ++i) {
             for (int j = 0; j < n; ++j) {
                 for (int k = 0; k < n; ++k) {
-                    def.position = {edyn::scalar(0.4 * j),
-                                    edyn::scalar(0.4 * i + 0.6),
-                                    edyn::scalar(0.4 * k)};
-                    edyn::make_rigidbody(*m_registry, def);
+                    positions.push_back({edyn::scalar(0.4 * j),
+                                         edyn::scalar(0.4 * i + 0.6),
+                                         edyn::scalar(0.4 * k)});
                 }
             }
         }
+
+        MakeRigidBodies(*m_registry, def, positions.data(), positions.size());
     }
 };
 
@@ -1,5 +1,5 @@
 #include "edyn_example.hpp"
-#include <edyn/util/shape_io.hpp>
+#include "baked_asset.hpp"
 
 class ExampleCompound : public EdynExample
 {
@@ -39,9 +39,14 @@ public:
         compound.add_shape(edyn::box_shape{ 0.5, 0.05, 0.05}, { 0.0, 0, -0.2}, edyn::quaternion_identity);
         compound.finish();
     #elif COMPOUND_TYPE == COMPOUND_TYPE_OBJ
-        auto obj_path = "../../../edyn-testbed/resources/chain_link.obj";
-        auto compound = edyn::load_compound_shape_from_obj(obj_path,
-            edyn::vector3_zero, edyn::quaternion_axis_angle({0, 1, 0}, edyn::pi * 0.5));
+        // Chain link rotated 90 degrees around the y axis.
+        auto baked_compound = LoadBakedCompound("chain_link_rotated");
+
+        if (!baked_compound) {
+            return;
+        }
+
+        auto compound = *baked_compound;
     #endif
 
         auto dyn_def = edyn::rigidbody_def();
@@ -18,6 +18,14 @@ void cmdStepSimulation(const void* _userData) {
     ((EdynExample *)_userData)->stepPhysics();
 }
 
+void cmdStepBackSimulation(const void* _userData) {
+    ((EdynExample *)_userData)->stepBackPhysics();
+}
+
+void cmdResetScene(const void* _userData) {
+    ((EdynExample *)_userData)->resetScene();
+}
+
 void OnCreateIsland(entt::registry &registry, entt::entity entity) {
     registry.emplace<ColorComponent>(entity, 0xff000000 | (0x00ffffff & rand()));
 }
@@ -89,11 +97,15 @@ void EdynExample::init(int32_t _argc, const char* const* _argv, uint32_t _width,
     m_num_position_iterations = edyn::get_solver_position_iterations(*m_registry);
     m_gui_gravity = m_gravity = -edyn::get_gravity(*m_registry).y;
 
+    EnableRewind(*m_registry);
+
     // Input bindings
-    m_bindings = (InputBinding*)BX_ALLOC(entry::getAllocator(), sizeof(InputBinding)*3);
+    m_bindings = (InputBinding*)BX_ALLOC(entry::getAllocator(), sizeof(InputBinding)*5);
     m_bindings[0].set(entry::Key::KeyP, entry::Modifier::None, 1, cmdTogglePause,  this);
     m_bindings[1].set(entry::Key::KeyL, entry::Modifier::None, 1, cmdStepSimulation, this);
-    m_bindings[2].end();
+    m_bindings[2].set(entry::Key::KeyK, entry::Modifier::None, 1, cmdStepBackSimulation, this);
+    m_bindings[3].set(entry::Key::KeyR, entry::Modifier::None, 1, cmdResetScene, this);
+    m_bindings[4].end();
 
     inputAddBindings("base", m_bindings);
 
@@ -104,10 +116,19 @@ void EdynExample::init(int32_t _argc, const char* const* _argv, uint32_t _width,
 #endif
 
     createScene();
+
+    if (!m_scene_builder.isStaticWorldReady()) {
+        edyn::set_paused(*m_registry, true);
+    }
+
+    if (!m_scene_builder.isBuilding() && canRestoreSnapshot()) {
+        m_initial_snapshot = TakeWorldSnapshot(*m_registry);
+    }
 }
 
 int EdynExample::shutdown()
 {
+    m_scene_builder.cancel();
     destroyScene();
 
     // Cleanup.
@@ -123,6 +144,7 @@ int EdynExample::shutdown()
     // Shutdown bgfx.
     bgfx::shutdown();
 
+    DisableRewind(*m_registry);
     edyn::detach(*m_registry);
 
 #ifdef EDYN_SOUND_ENABLED
@@ -175,8 +197,20 @@ bool EdynExample::update()
 
     updatePicking(viewMtx, proj);
 
+    updateSceneBuilder();
+
     updatePhysics(deltaTime);
 
+    // Record each step once its state has reached the main registry, which
+    // happens in a later update when running asynchronously. This also
+    // covers steps taken while paused.
+    auto simulation_timestamp = edyn::get_simulation_timestamp(*m_registry);
+
+    if (simulation_timestamp > m_rewind_record_timestamp) {
+        RecordRewindFrame(*m_registry);
+        m_rewind_record_timestamp = simulation_timestamp;
+    }
+
     // Draw stuff.
     DebugDrawEncoder dde;
     dde.begin(0);
@@ -348,7 +382,23 @@ bool EdynExample::update()
         }
     }
 
+    // Draw recorded contacts while rewound, with length proportional to
+    // the impulse.
+    if (IsRewound(*m_registry)) {
+        dde.push();
+        dde.setColor(0xff00ccff);
+
+        for (auto &contact : GetRewindContacts(*m_registry)) {
+            auto tip = contact.point + contact.normal * (0.05 + contact.normal_impulse * 0.1);
+            dde.moveTo(contact.point.x, contact.point.y, contact.point.z);
+            dde.lineTo(tip.x, tip.y, tip.z);
+        }
+
+        dde.pop();
+    }
+
     drawRaycast(dde);
+    drawCustom(dde);
 
     dde.end();
 
@@ -759,14 +809,68 @@ void EdynExample::togglePausePhysics() {
 }
 
 void EdynExample::stepPhysics() {
+    if (m_pause && m_scene_builder.isStaticWorldReady()) {
+        // Step through the recorded frames before stepping the simulation.
+        if (!SeekRewind(*m_registry, 1)) {
+            edyn::step_simulation(*m_registry);
+        }
+    }
+}
+
+void EdynExample::stepBackPhysics() {
     if (m_pause) {
-        edyn::step_simulation(*m_registry);
+        SeekRewind(*m_registry, -1);
     }
 }
 
 void EdynExample::setPaused(bool paused) {
     m_pause = paused;
-    edyn::set_paused(*m_registry, m_pause);
+
+    // Stays paused while the static world is built and resumes only
+    // if not paused by then.
+    if (m_scene_builder.isStaticWorldReady()) {
+        edyn::set_paused(*m_registry, m_pause);
+    }
+}
+
+void EdynExample::updateSceneBuilder() {
+    if (!m_scene_builder.isBuilding()) {
+        return;
+    }
+
+    auto was_ready = m_scene_builder.isStaticWorldReady();
+    m_scene_builder.update(*m_registry, m_scene_build_budget);
+
+    if (!was_ready && m_scene_builder.isStaticWorldReady()) {
+        edyn::set_paused(*m_registry, m_pause);
+    }
+
+    if (!m_scene_builder.isBuilding() && canRestoreSnapshot()) {
+        m_initial_snapshot = TakeWorldSnapshot(*m_registry);
+    }
+}
+
+void EdynExample::resetScene() {
+    if (m_scene_builder.isBuilding()) {
+        return;
+    }
+
+    // Drop the pick body, which is not part of the snapshot.
+    if (m_pick_entity != entt::null) {
+        m_registry->destroy(m_pick_constraint_entity);
+        m_registry->destroy(m_pick_entity);
+        m_pick_constraint_entity = entt::null;
+        m_pick_entity = entt::null;
+    }
+
+    m_picking = false;
+
+    if (!m_initial_snapshot.empty()) {
+        RestoreWorldSnapshot(*m_registry, m_initial_snapshot);
+    }
+
+    onSceneReset();
+    ClearRewind(*m_registry);
 }
 
 void EdynExample::updateGUI() {
@@ -784,6 +888,7 @@ void EdynExample::updateGUI() {
     showSettings();
     showProfiling();
     showFooter();
+    showSceneProgress();
 
     imguiEndFrame();
 }
@@ -804,6 +909,12 @@ void EdynExample::showSettings() {
     ImGui::SliderInt("Position Iterations", &m_num_position_iterations, 0, 100);
     ImGui::SliderFloat("Gravity (m/s^2)", &m_gui_gravity, 0, 50, "%.2f");
 
+    showCustomSettings();
+
+    if (ImGui::Button("Export replay")) {
+        ExportRewindReplay(*m_registry, "replay.edrw");
+    }
+
     ImGui::End();
 }
 
@@ -839,6 +950,12 @@ void EdynExample::showProfiling() {
         ImGui::LabelText("Network down (kB/s)", "%.1f", network->incoming_rate * 1e-3);
     }
 
+    auto rewind = GetRewindStats(*m_registry);
+    ImGui::LabelText("Rewind (s)",    "%.1f", rewind.window_duration);
+    ImGui::LabelText("Rewind (KiB)",  "%zu", rewind.used_bytes >> 10);
+
+    showCustomProfiling();
+
     ImGui::PopItemWidth();
 
     ImGui::End();
@@ -859,6 +976,24 @@ void EdynExample::showFooter() {
     ImGui::End();
 }
 
+void EdynExample::showSceneProgress() {
+    if (!m_scene_builder.isBuilding()) {
+        return;
+    }
+
+    ImGui::SetNextWindowPos(ImVec2(m_width / 2.0f, m_height / 2.0f), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+    ImGui::SetNextWindowSize(ImVec2(m_width / 3.0f, 0.f));
+
+    ImGui::Begin("Loading", NULL, ImGuiWindowFlags_NoTitleBar |
+                                  ImGuiWindowFlags_NoResize |
+                                  ImGuiWindowFlags_NoMouseInputs);
+
+    ImGui::Text("%s", m_scene_builder.currentLabel().c_str());
+    ImGui::ProgressBar(m_scene_builder.progress(), ImVec2(-1.f, 0.f));
+
+    ImGui::End();
+}
+
 void EdynExample::updateSettings() {
     auto fixed_dt_ms = static_cast<int>(edyn::get_fixed_dt(*m_registry) * 1000);
     if (fixed_dt_ms != m_fixed_dt_ms) {
@@ -1,16 +1,21 @@
 #include <edyn/context/task.hpp>
 #include <enkiTS/TaskScheduler.h>
 #include "edyn_example.hpp"
+#include "adaptive_grain.hpp"
 
 enki::TaskScheduler g_TS;
+static AdaptiveGrainController *g_grain_controller {nullptr};
 
 struct CompletionActionDelete : public enki::ICompletable
 {
     enki::Dependency m_dependency;
     edyn::task_completion_delegate_t m_completion;
+    AdaptiveGrainController::Sample *m_sample;
 
     void OnDependenciesComplete(enki::TaskScheduler* scheduler, uint32_t threadNum)
     {
+        g_grain_controller->end(*m_sample);
+
         if (m_completion) {
             m_completion();
         }
@@ -24,24 +29,39 @@ struct DelegateWithCompletionTaskSet : public enki::ITaskSet {
     CompletionActionDelete m_task_deleter;
     enki::Dependency m_dependency;
     edyn::task_delegate_t m_task;
+    AdaptiveGrainController::Sample m_sample;
 
-    DelegateWithCompletionTaskSet(uint32_t size, uint32_t grain) : enki::ITaskSet(size, grain)
+    DelegateWithCompletionTaskSet(uint32_t size)
     {
+        g_grain_controller->begin(m_sample, size);
+        m_SetSize = size;
+        m_MinRange = m_sample.grain;
+        m_task_deleter.m_sample = &m_sample;
         m_task_deleter.SetDependency(m_task_deleter.m_dependency, this);
     }
 
     void ExecuteRange(enki::TaskSetPartition range, uint32_t threadnum) override {
+        auto start = AdaptiveGrainController::clock::now();
         m_task(range.start, range.end);
+        m_sample.addBusyTime(start);
     }
 };
 
 struct DelegateTaskSet : public enki::ITaskSet {
     edyn::task_delegate_t m_task;
+    AdaptiveGrainController::Sample m_sample;
 
-    DelegateTaskSet(uint32_t size, uint32_t grain) : enki::ITaskSet(size, grain) {}
+    DelegateTaskSet(uint32_t size)
+    {
+        g_grain_controller->begin(m_sample, size);
+        m_SetSize = size;
+        m_MinRange = m_sample.grain;
+    }
 
     void ExecuteRange(enki::TaskSetPartition range, uint32_t threadnum) override {
+        auto start = AdaptiveGrainController::clock::now();
         m_task(range.start, range.end);
+        m_sample.addBusyTime(start);
     }
 };
 
@@ -56,6 +76,7 @@ public:
     void init(int32_t _argc, const char* const* _argv, uint32_t _width, uint32_t _height) override
     {
         g_TS.Initialize();
+        g_grain_controller = new AdaptiveGrainController(g_TS.GetNumTaskThreads());
         EdynExample::init(_argc, _argv, _width, _height);
     }
 
@@ -63,6 +84,8 @@ public:
     {
         auto ret = EdynExample::shutdown();
         g_TS.WaitforAllAndShutdown();
+        delete g_grain_controller;
+        g_grain_controller = nullptr;
         return ret;
     }
 
@@ -71,22 +94,26 @@ public:
         auto config = edyn::init_config{};
         config.execution_mode = edyn::execution_mode::asynchronous;
         config.enqueue_task = [](edyn::task_delegate_t task, unsigned size, edyn::task_completion_delegate_t completion) {
-            auto grain_size = std::max(size / g_TS.GetNumTaskThreads(), 1u);
-            auto task_set = new DelegateWithCompletionTaskSet(size, grain_size);
+            auto task_set = new DelegateWithCompletionTaskSet(size);
             task_set->m_task = std::move(task);
             task_set->m_task_deleter.m_completion = std::move(completion);
             g_TS.AddTaskSetToPipe(task_set);
         };
         config.enqueue_task_wait = [](edyn::task_delegate_t task, unsigned size) {
-            auto grain_size = std::max(size / g_TS.GetNumTaskThreads(), 1u);
-            DelegateTaskSet task_set(size, grain_size);
+            DelegateTaskSet task_set(size);
             task_set.m_task = std::move(task);
             g_TS.AddTaskSetToPipe(&task_set);
             g_TS.WaitforTask(&task_set);
+            g_grain_controller->end(task_set.m_sample);
         };
         EdynExample::initEdyn(config);
     }
 
+    void showCustomProfiling() override
+    {
+        showGrainProfiling("Task grain", *g_grain_controller);
+    }
+
     void createScene() override
     {
         // Create floor
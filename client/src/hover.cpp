@@ -1,4 +1,6 @@
 #include "edyn_example.hpp"
+#include "batch_raycast.hpp"
+#include "shape_cast.hpp"
 #include <edyn/replication/register_external.hpp>
 #include <edyn/util/aabb_util.hpp>
 #include <edyn/util/shape_util.hpp>
@@ -18,75 +20,155 @@ struct HoverForce {
     std::array<RayForce, max_count> rays;
 };
 
-void ApplyRayForces(entt::registry &registry) {
+// Rays of all hover bodies, cast together every step. Kept in the registry
+// context to reuse the buffer.
+struct HoverRayBatch {
+    std::vector<BatchRay> rays;
+};
+
+// Use a set of 4 springs per corner. Cast a ray for each.
+constexpr auto num_springs = 4;
+
+// Applies the spring and damping impulses of one hit. `share` is the number
+// of hits the spring force is split among.
+void ApplySpringImpulse(entt::registry &registry, entt::entity entity, const HoverForce::RayForce &ray,
+                        const edyn::vector3 &dir, const edyn::vector3 &p0,
+                        const edyn::raycast_result &res, int share) {
     auto dt = edyn::get_fixed_dt(registry);
     auto vel_view = registry.view<edyn::linvel, edyn::angvel>();
     auto tr_view = registry.view<edyn::position, edyn::orientation>();
-    auto view = registry.view<HoverForce, edyn::position, edyn::orientation>().each();
     auto dyn_view = registry.view<edyn::dynamic_tag>();
+    auto pos = tr_view.get<edyn::position>(entity);
 
-    for (auto [entity, coll, pos, orn] : view) {
-        for (int i = 0; i < coll.count; ++i) {
+    auto inclination_factor = std::abs(edyn::dot(res.normal, dir));
+    auto spring_force = (edyn::scalar(1) - res.fraction) * ray.length * ray.stiffness * inclination_factor * res.normal;
+    edyn::vector3 velA = {0,0,0}, velB = {0,0,0};
+
+    if (vel_view.contains(entity)) {
+        velA = vel_view.get<edyn::linvel>(entity) + edyn::cross(vel_view.get<edyn::angvel>(entity), p0 - pos);
+    }
+
+    if (vel_view.contains(res.entity)) {
+        velB = vel_view.get<edyn::linvel>(res.entity) +
+               edyn::cross(vel_view.get<edyn::angvel>(res.entity), p0 - tr_view.get<edyn::position>(res.entity));
+    }
+
+    auto rel_vel = velA - velB;
+    auto normal_rel_vel = res.normal * edyn::dot(-rel_vel, res.normal);
+    auto damping_force = normal_rel_vel * ray.damping;
+
+    // Divide impulse by the number of rays that intersected for
+    // correct force distribution.
+    auto impulse = (spring_force + damping_force) * dt / share;
+    edyn::rigidbody_apply_impulse(registry, entity, impulse, p0 - pos);
+
+    if (dyn_view.contains(res.entity)) {
+        auto pos_other = tr_view.get<edyn::position>(res.entity);
+        edyn::rigidbody_apply_impulse(registry, res.entity, -impulse, p0 - pos_other);
+    }
+}
+
+void ApplyRayResults(entt::registry &registry, const BatchRay *rays,
+                     const edyn::raycast_result *results, size_t count) {
+    auto view = registry.view<HoverForce, edyn::position, edyn::orientation>();
+
+    // Iterate in the same order rays were inserted.
+    size_t ray_idx = 0;
+
+    for (auto [entity, coll, pos, orn] : view.each()) {
+        for (int i = 0; i < coll.count; ++i, ray_idx += num_springs) {
             auto &ray = coll.rays[i];
             auto dir = rotate(orn, ray.dir);
-
-            // Use a set of 4 springs per corner. Cast a ray for each.
-            constexpr auto num_springs = 4;
-            std::array<edyn::vector3, num_springs> ray_locs;
-            std::array<edyn::raycast_result, num_springs> results;
-            std::vector<entt::entity> ignore;
-            ignore.push_back(entity);
             int count = 0;
 
             for (int j = 0; j < num_springs; ++j) {
-                auto ray_loc_offset_unit = edyn::vector3{edyn::scalar(j % 2 == 0 ? 1 : -1), 0,
-                                                         edyn::scalar(j < 2 ? 1 : -1)};
-                auto ray_loc = ray.loc + ray_loc_offset_unit * ray.radius;
-                auto p0 = edyn::to_world_space(ray_loc, pos, orn);
-                auto p1 = p0 + dir * ray.length;
-                auto res = edyn::raycast(registry, p0, p1, {entity});
-
-                if (res.entity != entt::null) {
-                    results[count] = res;
-                    ray_locs[count] = p0;
+                if (results[ray_idx + j].entity != entt::null) {
                     ++count;
                 }
             }
 
             // Only apply forces for rays that intersected something.
-            for (int j = 0; j < count; ++j) {
-                auto &res = results[j];
-                auto p0 = ray_locs[j];
-
-                auto inclination_factor = std::abs(edyn::dot(res.normal, dir));
-                auto spring_force = (edyn::scalar(1) - res.fraction) * ray.length * ray.stiffness * inclination_factor * res.normal;
-                edyn::vector3 velA = {0,0,0}, velB = {0,0,0};
+            for (int j = 0; j < num_springs; ++j) {
+                auto &res = results[ray_idx + j];
 
-                if (vel_view.contains(entity)) {
-                    velA = vel_view.get<edyn::linvel>(entity) + edyn::cross(vel_view.get<edyn::angvel>(entity), p0 - pos);
+                if (res.entity != entt::null) {
+                    ApplySpringImpulse(registry, entity, ray, dir, rays[ray_idx + j].p0, res, count);
                 }
+            }
+        }
+    }
+}
 
-                if (vel_view.contains(res.entity)) {
-                    velB = vel_view.get<edyn::linvel>(res.entity) +
-                           edyn::cross(vel_view.get<edyn::angvel>(res.entity), p0 - tr_view.get<edyn::position>(res.entity));
-                }
+void ApplyRayForces(entt::registry &registry) {
+    auto view = registry.view<HoverForce, edyn::position, edyn::orientation>();
+    auto *batch = registry.ctx().find<HoverRayBatch>();
 
-                auto rel_vel = velA - velB;
-                auto normal_rel_vel = res.normal * edyn::dot(-rel_vel, res.normal);
-                auto damping_force = normal_rel_vel * ray.damping;
+    if (batch == nullptr) {
+        batch = &registry.ctx().emplace<HoverRayBatch>();
+    }
 
-                // Divide impulse by the number of rays that intersected for
-                // correct force distribution.
-                auto impulse = (spring_force + damping_force) * dt / count;
-                edyn::rigidbody_apply_impulse(registry, entity, impulse, p0 - pos);
+    batch->rays.clear();
 
-                if (dyn_view.contains(res.entity)) {
-                    auto pos_other = tr_view.get<edyn::position>(res.entity);
-                    edyn::rigidbody_apply_impulse(registry, res.entity, -impulse, p0 - pos_other);
-                }
+    for (auto [entity, coll, pos, orn] : view.each()) {
+        for (int i = 0; i < coll.count; ++i) {
+            auto &ray = coll.rays[i];
+            auto dir = rotate(orn, ray.dir);
+
+            for (int j = 0; j < num_springs; ++j) {
+                auto ray_loc_offset_unit = edyn::vector3{edyn::scalar(j % 2 == 0 ? 1 : -1), 0,
+                                                         edyn::scalar(j < 2 ? 1 : -1)};
+                auto ray_loc = ray.loc + ray_loc_offset_unit * ray.radius;
+                auto &batch_ray = batch->rays.emplace_back();
+                batch_ray.p0 = edyn::to_world_space(ray_loc, pos, orn);
+                batch_ray.p1 = batch_ray.p0 + dir * ray.length;
+                batch_ray.ignore[0] = entity;
+                batch_ray.owner = entity;
+                batch_ray.owner_index = static_cast<uint32_t>(i * num_springs + j);
             }
         }
     }
+
+    // Forces are applied in one go after all rays are done.
+    auto delegate = BatchRaycastDelegate(entt::connect_arg_t<&ApplyRayResults>{}, registry);
+    BatchRaycastParallel(registry, batch->rays.data(), batch->rays.size(), delegate);
+}
+
+void ApplySweepResult(entt::registry &registry, const ShapeCast &cast, const edyn::raycast_result &result) {
+    if (result.entity == entt::null || !registry.all_of<HoverForce>(cast.owner)) {
+        return;
+    }
+
+    auto &coll = registry.get<HoverForce>(cast.owner);
+    auto &orn = registry.get<edyn::orientation>(cast.owner);
+    auto &ray = coll.rays[cast.owner_index];
+    auto dir = rotate(orn, ray.dir);
+    ApplySpringImpulse(registry, cast.owner, ray, dir, cast.p0, result, 1);
+}
+
+// Sweeps one sphere per ray force instead of casting a bundle of rays around
+// it, which covers the whole footprint at once.
+void ApplySweepForces(entt::registry &registry) {
+    auto view = registry.view<HoverForce, edyn::position, edyn::orientation>();
+    auto delegate = ShapeCastDelegate(entt::connect_arg_t<&ApplySweepResult>{}, registry);
+
+    for (auto [entity, coll, pos, orn] : view.each()) {
+        for (int i = 0; i < coll.count; ++i) {
+            auto &ray = coll.rays[i];
+            auto dir = rotate(orn, ray.dir);
+            auto cast = ShapeCast{};
+            cast.kind = ShapeCastKind::Sphere;
+            cast.radius = ray.radius;
+            // Start one radius up so the sweep covers the same range as rays.
+            cast.p0 = edyn::to_world_space(ray.loc, pos, orn) - dir * ray.radius;
+            cast.p1 = cast.p0 + dir * ray.length;
+            cast.ignore[0] = entity;
+            cast.owner = entity;
+            cast.owner_index = static_cast<uint32_t>(i);
+            ShapeCastAsync(registry, cast, delegate);
+        }
+    }
+
+    FlushShapeCasts(registry);
 }
 
 class ExampleHover : public EdynExample
@@ -100,6 +182,18 @@ public:
 
     virtual ~ExampleHover() {}
 
+    void showCustomSettings() override {
+        static const char *modes[] = {"Rays", "Sphere casts"};
+
+        if (ImGui::Combo("Hover query", &m_query_mode, modes, 2)) {
+            if (m_query_mode == 0) {
+                edyn::set_pre_step_callback(*m_registry, &ApplyRayForces);
+            } else {
+                edyn::set_pre_step_callback(*m_registry, &ApplySweepForces);
+            }
+        }
+    }
+
     void createScene() override
     {
         edyn::register_external_components<HoverForce>(*m_registry);
@@ -175,6 +269,9 @@ public:
             edyn::make_rigidbody(*m_registry, def);
         }
     }
+
+private:
+    int m_query_mode {0};
 };
 
 ENTRY_IMPLEMENT_MAIN(
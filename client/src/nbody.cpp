@@ -0,0 +1,134 @@
+#include "edyn_example.hpp"
+#include "nbody_gravity.hpp"
+#include <random>
+#include <edyn/replication/register_external.hpp>
+
+class ExampleNBody : public EdynExample
+{
+public:
+    ExampleNBody(const char* _name, const char* _description, const char* _url)
+        : EdynExample(_name, _description, _url)
+    {
+
+    }
+
+    void createScene() override
+    {
+        edyn::register_external_components<NBodyGravity>(*m_registry);
+        edyn::set_pre_step_callback(*m_registry, &ApplyNBodyGravity);
+        createParticles();
+    }
+
+    void destroyScene() override {
+        EdynExample::destroyScene();
+        edyn::remove_external_components(*m_registry);
+        edyn::set_pre_step_callback(*m_registry, nullptr);
+    }
+
+    // Particles are recreated on reset since the central body holds the
+    // gravity settings and pairwise mode has a constraint per pair.
+    bool canRestoreSnapshot() const override { return false; }
+
+    void onSceneReset() override {
+        destroyParticles();
+        createParticles();
+    }
+
+    void showCustomSettings() override {
+        static const char *modes[] = {"Barnes-Hut", "Pairwise constraints"};
+
+        if (ImGui::Combo("Gravity", &m_mode, modes, 2)) {
+            destroyParticles();
+            createParticles();
+        }
+
+        if (m_mode == 0) {
+            ImGui::SliderInt("Particles", &m_num_particles, 100, 100000);
+
+            if (ImGui::SliderFloat("Theta", &m_theta, 0, 1.2f, "%.2f") && m_gravity_entity != entt::null) {
+                m_registry->patch<NBodyGravity>(m_gravity_entity, [&](NBodyGravity &gravity) {
+                    gravity.theta = m_theta;
+                });
+            }
+        } else {
+            // Every pair gets a constraint, thus it doesn't go much further.
+            ImGui::SliderInt("Particles", &m_num_pairwise_particles, 2, 500);
+            ImGui::Text("Constraints: %d", m_num_pairwise_particles * (m_num_pairwise_particles - 1) / 2);
+        }
+
+        if (ImGui::Button("Reset particles")) {
+            destroyParticles();
+            createParticles();
+        }
+    }
+
+    void createParticles() {
+        auto num_particles = m_mode == 0 ? m_num_particles : m_num_pairwise_particles;
+
+        // A heavy body at the center with a disk of light bodies orbiting it.
+        auto def = edyn::rigidbody_def();
+        def.gravity = edyn::vector3_zero;
+        def.position = {0, 3, 0};
+        def.mass = 1e12;
+        def.inertia = edyn::diagonal_matrix({1e11, 1e11, 1e11});
+        m_particles.push_back(edyn::make_rigidbody(*m_registry, def));
+
+        auto rng = std::mt19937(42);
+        auto radius_dist = std::uniform_real_distribution<edyn::scalar>(4, 40);
+        auto angle_dist = std::uniform_real_distribution<edyn::scalar>(0, edyn::pi2);
+        auto height_dist = std::normal_distribution<edyn::scalar>(0, 0.3);
+        auto particle_mass = edyn::scalar(1e11) / num_particles;
+        def.mass = particle_mass;
+        def.inertia = edyn::diagonal_matrix(edyn::vector3_one * particle_mass * edyn::scalar(0.1));
+
+        for (int i = 0; i < num_particles; ++i) {
+            auto radius = radius_dist(rng);
+            auto angle = angle_dist(rng);
+            auto dir = edyn::vector3{std::cos(angle), 0, std::sin(angle)};
+            def.position = edyn::vector3{0, 3 + height_dist(rng), 0} + dir * radius;
+
+            // Circular orbit around the mass enclosed by the orbit, assuming
+            // the disk mass grows linearly with the radius.
+            auto enclosed_mass = 1e12 + 1e11 * (radius - 4) / 36;
+            auto speed = std::sqrt(edyn::gravitational_constant * enclosed_mass / radius);
+            def.linvel = edyn::cross(edyn::vector3_y, dir) * speed;
+            m_particles.push_back(edyn::make_rigidbody(*m_registry, def));
+        }
+
+        if (m_mode == 0) {
+            // Keep the settings in the central body so they're synchronized
+            // along with it.
+            m_gravity_entity = m_particles.front();
+            auto &gravity = m_registry->emplace<NBodyGravity>(m_gravity_entity);
+            gravity.theta = m_theta;
+        } else {
+            for (size_t i = 0; i < m_particles.size(); ++i) {
+                for (size_t j = i + 1; j < m_particles.size(); ++j) {
+                    edyn::make_constraint<edyn::gravity_constraint>(*m_registry, m_particles[i], m_particles[j]);
+                }
+            }
+        }
+    }
+
+    void destroyParticles() {
+        // Constraints are destroyed along with the bodies.
+        m_registry->destroy(m_particles.begin(), m_particles.end());
+        m_particles.clear();
+        m_gravity_entity = entt::null;
+    }
+
+private:
+    int m_mode {0};
+    int m_num_particles {10000};
+    int m_num_pairwise_particles {200};
+    float m_theta {0.5f};
+    std::vector<entt::entity> m_particles;
+    entt::entity m_gravity_entity {entt::null};
+};
+
+ENTRY_IMPLEMENT_MAIN(
+    ExampleNBody
+    , "36-nbody"
+    , "Large number of particles attracting one another with Barnes-Hut gravity."
+    , "https://github.com/xissburg/edyn-testbed"
+    );
@@ -1,4 +1,5 @@
 #include "networking.hpp"
+#include "async_log.hpp"
 #include "server_ports.hpp"
 #include <edyn/edyn.hpp>
 #include <edyn/networking/networking.hpp>
@@ -8,7 +9,6 @@
 #include <edyn/networking/extrapolation/extrapolation_callback.hpp>
 #include <edyn/time/time.hpp>
 #include <edyn/util/rigidbody.hpp>
-#include <iomanip>
 #include <unordered_set>
 #include <enet/enet.h>
 #include <iostream>
@@ -19,7 +19,7 @@ void UnregisterNetworkedComponents(entt::registry &);
 void cmdToggleExtrapolation(const void* _userData);
 
 void PrintExtrapolationTimeoutWarning() {
-    std::cout << "WARNING: Extrapolation timed out." << std::endl;
+    Log("WARNING: Extrapolation timed out.");
 }
 
 ExampleNetworking::ExampleNetworking(const char* _name, const char* _description, const char* _url)
@@ -102,7 +102,7 @@ void ExampleNetworking::onConstructRigidBody(entt::registry &registry, entt::ent
 void ExampleNetworking::toggleExtrapolation()
 {
     edyn::toggle_network_client_extrapolation_enabled(*m_registry);
-    std::cout << "Extrapolation " << (edyn::get_network_client_extrapolation_enabled(*m_registry) ? "enabled" : "disabled") << std::endl;
+    Log("Extrapolation %s", edyn::get_network_client_extrapolation_enabled(*m_registry) ? "enabled" : "disabled");
 }
 
 void ExampleNetworking::createScene()
@@ -250,9 +250,8 @@ void ExampleNetworking::updatePhysics(float deltaTime)
         m_data_outgoing_total_prev = m_host->totalSentData;
         m_data_incoming_total_prev = m_host->totalReceivedData;
 
-        std::cout << std::setiosflags(std::ios::fixed) << std::setprecision(3)
-            << "Network data rate(kB/s): up " << network_outgoing_data_rate
-            << " | down " << network_incoming_data_rate << ", RTT " << std::dec << m_peer->roundTripTime << std::endl;
+        Log("Network data rate(kB/s): up %.3f | down %.3f, RTT %u",
+            double(network_outgoing_data_rate), double(network_incoming_data_rate), unsigned(m_peer->roundTripTime));
     }
 #endif
 }
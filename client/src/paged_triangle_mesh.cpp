@@ -1,24 +1,25 @@
 #include "edyn_example.hpp"
+#include "async_log.hpp"
+#include "baked_asset.hpp"
+#include "contact_events.hpp"
+#include "mapped_page_loader.hpp"
+#include "page_cache.hpp"
+#include "page_prefetch.hpp"
 #include <edyn/collision/contact_point.hpp>
 #include <edyn/comp/tag.hpp>
 #include <edyn/serialization/paged_triangle_mesh_s11n.hpp>
-#include <edyn/shapes/create_paged_triangle_mesh.hpp>
-#include <edyn/util/shape_io.hpp>
 #include <edyn/util/paged_mesh_load_reporting.hpp>
-#include <iostream>
+#include <optional>
 
 void PageLoaded(entt::registry &registry, entt::entity entity, unsigned index) {
     auto &mesh = registry.get<edyn::paged_mesh_shape>(entity);
     auto trimesh = mesh.trimesh->get_submesh(index);
 
     if (trimesh) {
-        std::cout << "Page " << index << " loaded: "
-                << trimesh->num_vertices() << " verts, "
-                << trimesh->num_edges() << " edges, "
-                << trimesh->num_triangles() << " tris."
-                << std::endl;
+        Log("Page %u loaded: %zu verts, %zu edges, %zu tris.", index,
+            size_t(trimesh->num_vertices()), size_t(trimesh->num_edges()), size_t(trimesh->num_triangles()));
     } else {
-        std::cout << "Unloaded page " << index << std::endl;
+        Log("Unloaded page %u", index);
     }
 }
 
@@ -31,127 +32,166 @@ public:
 
     }
 
-    void contactStarted(entt::registry &registry, entt::entity entity) {
-        auto &cp_imp = registry.get<edyn::contact_point_impulse>(entity);
-        auto normal_impulse = cp_imp.normal_impulse + cp_imp.normal_restitution_impulse;
-        std::cout << "Started | impulse: " << normal_impulse << std::endl;
-    }
-
-    void contactPointDestroyed(entt::registry &registry, entt::entity entity) {
-        auto &cp = registry.get<edyn::contact_point>(entity);
-        auto lifetime = cp.lifetime;
-        std::cout << "Ended | lifetime: " << lifetime << std::endl;
+    void updatePhysics(float deltaTime) override {
+        EdynExample::updatePhysics(deltaTime);
+        UpdatePageCache(*m_registry);
+        UpdatePagePrefetch(*m_registry);
+
+        for (auto &event : PollContactEvents(*m_registry)) {
+            switch (event.type) {
+            case ContactEventType::Started:
+                Log(m_contact_log_limiter, "Started | impulse: %f", event.normal_impulse);
+                break;
+            case ContactEventType::Ended:
+                Log(m_contact_log_limiter, "Ended | lifetime: %u", event.lifetime);
+                break;
+            default:
+                break;
+            }
+        }
     }
 
-    virtual ~ExamplePagedTriangleMesh() {}
+    void showCustomSettings() override {
+        if (!m_has_terrain) {
+            return;
+        }
 
-    void createScene() override {
-        // Create floor
-        auto floor_def = edyn::rigidbody_def();
-        floor_def.kind = edyn::rigidbody_kind::rb_static;
-        floor_def.material->restitution = 0;
-        floor_def.material->friction = 0.8;
-
-        m_input = std::make_shared<edyn::paged_triangle_mesh_file_input_archive>("terrain_large.bin", edyn::get_enqueue_task(*m_registry));
-        auto paged_trimesh = std::make_shared<edyn::paged_triangle_mesh>(std::static_pointer_cast<edyn::triangle_mesh_page_loader_base>(m_input));
-        paged_trimesh->m_max_cache_num_vertices = 1 << 14;
-
-        if (m_input->is_file_open()) {
-            edyn::serialize(*m_input, *paged_trimesh);
-        } else {
-            // Load a large mesh, split it into smaller submeshes, write them to files
-            // and setup the paged triangle mesh to read them on demand.
-            std::vector<edyn::vector3> vertices;
-            std::vector<uint32_t> indices;
-            // Note: the working directory is bgfx/examples/runtime and it is
-            // assumed the edyn-testbed directory is at the same level.
-            auto obj_path = "../../../edyn-testbed/resources/terrain_large.obj";
-            edyn::load_tri_mesh_from_obj(obj_path, vertices, indices);
-
-            // Generate triangle mesh from .obj file. This splits the mesh into
-            // a bunch of smaller `triangle_mesh` which are stored in the
-            // `paged_triangle_mesh` nodes.
-            edyn::create_paged_triangle_mesh(
-                *paged_trimesh,
-                vertices.begin(), vertices.end(),
-                indices.begin(), indices.end(),
-                1 << 11, {}, {}, edyn::get_enqueue_task_wait(*m_registry));
-
-            {
-                // After creating the paged triangle mesh all nodes are loaded into
-                // the cache, then it's the best time to write them all to files.
-                // This scope is to ensure the file is commited to external storage
-                // before reading from it.
-                auto output = edyn::paged_triangle_mesh_file_output_archive("terrain_large.bin",
-                    edyn::paged_triangle_mesh_serialization_mode::external);
-                edyn::serialize(output, *paged_trimesh);
-                paged_trimesh->clear_cache();
-            }
+        auto horizon = float(GetPagePrefetchSettings(*m_registry).horizon);
 
-            // Now load it from file so the `paged_triangle_mesh_file_input_archive`
-            // knows where to load submeshes from.
-            m_input->open("terrain_large.bin");
-            edyn::serialize(*m_input, *paged_trimesh);
+        if (ImGui::SliderFloat("Prefetch horizon", &horizon, 0, 4, "%.1f s")) {
+            GetPagePrefetchSettings(*m_registry).horizon = horizon;
         }
 
-        floor_def.shape = edyn::paged_mesh_shape{paged_trimesh};
-        edyn::make_rigidbody(*m_registry, floor_def);
+        auto &cache_settings = GetPageCacheSettings(*m_registry);
+        auto budget_mib = static_cast<int>(cache_settings.budget_bytes >> 20);
 
-        // Add some dynamic entities.
-        {
-            auto def = edyn::rigidbody_def();
-            def.mass = 50;
-            def.material->friction = 0.4;
-            def.material->restitution = 0;
-
-            auto shapes_and_positions = std::vector<std::pair<edyn::shapes_variant_t, edyn::vector3>>{};
+        if (ImGui::SliderInt("Cache budget (MiB)", &budget_mib, 1, 64)) {
+            cache_settings.budget_bytes = size_t(budget_mib) << 20;
+        }
+    }
 
-            shapes_and_positions.emplace_back(
-                edyn::cylinder_shape{0.15, 0.2},
-                edyn::vector3{0, 1, 0});
+    void showCustomProfiling() override {
+        auto stats = GetPagePrefetchStats(*m_registry);
+        ImGui::LabelText("Prefetches", "%llu", (unsigned long long)stats.prefetches);
+        ImGui::LabelText("Prefetch hits", "%llu", (unsigned long long)stats.hits);
+        ImGui::LabelText("Page misses", "%llu", (unsigned long long)stats.misses);
+        ImGui::LabelText("Late page loads", "%llu", (unsigned long long)stats.late_loads);
+
+        auto &cache_stats = GetPageCacheStats(*m_registry);
+        ImGui::LabelText("Resident pages", "%zu", cache_stats.resident_pages);
+        ImGui::LabelText("Resident (KiB)", "%zu", cache_stats.resident_bytes >> 10);
+        ImGui::LabelText("Loads/s", "%.1f", cache_stats.load_rate);
+        ImGui::LabelText("Evictions/s", "%.1f", cache_stats.eviction_rate);
+        ImGui::LabelText("Thrashing", cache_stats.thrashing ? "yes (%.1f/s)" : "no (%.1f/s)", cache_stats.thrash_rate);
+    }
 
-            shapes_and_positions.emplace_back(
-                edyn::sphere_shape{0.2},
-                edyn::vector3{0.5, 1, 0});
+    virtual ~ExamplePagedTriangleMesh() {}
 
-            shapes_and_positions.emplace_back(
-                edyn::box_shape{0.2, 0.15, 0.25},
-                edyn::vector3{1.1, 0.9, 0});
+    void createScene() override {
+        // Submeshes are paged in from a memory mapped file whereas the tree
+        // and the rest of the structure come from `terrain_large.bin`. Both
+        // are produced by the baker. Everything is loaded in the background
+        // and the simulation starts once the terrain is in.
+        auto *enqueue_task = edyn::get_enqueue_task(*m_registry);
+        m_loader = std::make_shared<MappedPageLoader>(enqueue_task);
+        auto paged_trimesh = std::make_shared<edyn::paged_triangle_mesh>(std::static_pointer_cast<edyn::triangle_mesh_page_loader_base>(m_loader));
+        auto loader = m_loader;
+
+        m_scene_builder.load("Loading terrain", [loader, paged_trimesh, enqueue_task] {
+            auto structure_path = std::string(baked_asset_directory) + "terrain_large.bin";
+            auto pages_path = std::string(baked_asset_directory) + "terrain_large.pages";
+
+            // The structure file is only read once the page file confirmed
+            // it's the one the pages were baked with.
+            if (loader->open(pages_path, structure_path)) {
+                auto input = edyn::paged_triangle_mesh_file_input_archive(structure_path, enqueue_task);
+
+                if (input.is_file_open()) {
+                    edyn::serialize(input, *paged_trimesh);
+                }
+            }
 
-            shapes_and_positions.emplace_back(
-                edyn::capsule_shape{0.15, 0.2},
-                edyn::vector3{1.6, 1, 0});
+            if (!loader->isOpen() || paged_trimesh->number_of_submeshes() != loader->numPages()) {
+                Log("Missing or invalid baked asset %s. Run EdynTestbedBaker to bake resources.", pages_path.c_str());
+                loader->close();
+            }
+        });
+
+        auto positions = std::vector<edyn::vector3>{
+            {0, 1, 0}, {0.5, 1, 0}, {1.1, 0.9, 0}, {1.6, 1, 0}, {2.1, 0.9, 0}, {2.5, 1, 0}
+        };
+        // One shape per position. Shapes which failed to load are left empty
+        // so only their own body is skipped.
+        auto shapes = std::make_shared<std::vector<std::optional<edyn::shapes_variant_t>>>(positions.size());
+
+        m_scene_builder.load("Loading shapes", [shapes] {
+            (*shapes)[0] = edyn::cylinder_shape{0.15, 0.2};
+            (*shapes)[1] = edyn::sphere_shape{0.2};
+            (*shapes)[2] = edyn::box_shape{0.2, 0.15, 0.25};
+            (*shapes)[3] = edyn::capsule_shape{0.15, 0.2};
+
+            if (auto shape = LoadBakedPolyhedron("rock_scaled")) {
+                (*shapes)[4] = *shape;
+            }
 
-            shapes_and_positions.emplace_back(
-                edyn::load_convex_polyhedrons_from_obj("../../../edyn-testbed/resources/rock.obj",
-                                                       {0,0,0}, {0,0,0,1}, {0.8,0.9,1.1}).front().shape,
-                edyn::vector3{2.1, 0.9, 0});
+            if (auto shape = LoadBakedCompound("chain_link")) {
+                (*shapes)[5] = *shape;
+            }
+        });
 
-            shapes_and_positions.emplace_back(
-                edyn::load_compound_shape_from_obj("../../../edyn-testbed/resources/chain_link.obj"),
-                edyn::vector3{2.5, 1, 0});
+        m_scene_builder.build("Creating terrain", [this, paged_trimesh](entt::registry &registry) {
+            if (!m_loader->isOpen()) {
+                return;
+            }
 
-            for (auto [shape, pos] : shapes_and_positions) {
-                def.position = pos;
-                def.shape = shape;
-                edyn::make_rigidbody(*m_registry, def);
+            // Create floor
+            auto floor_def = edyn::rigidbody_def();
+            floor_def.kind = edyn::rigidbody_kind::rb_static;
+            floor_def.material->restitution = 0;
+            floor_def.material->friction = 0.8;
+            floor_def.shape = edyn::paged_mesh_shape{paged_trimesh};
+            auto floor_entity = edyn::make_rigidbody(registry, floor_def);
+            EnablePageCache(registry, floor_entity, m_loader);
+            EnablePagePrefetch(registry, floor_entity, m_loader);
+            m_has_terrain = true;
+        });
+
+        m_scene_builder.staticWorldReady();
+
+        // Add some dynamic entities, one per shape.
+        m_scene_builder.buildBatched("Creating bodies", positions.size(), [shapes, positions](entt::registry &registry, size_t index) {
+            if (!(*shapes)[index]) {
+                return;
             }
-        }
+
+            auto def = edyn::rigidbody_def();
+            def.mass = 50;
+            def.material->friction = 0.4;
+            def.material->restitution = 0;
+            def.position = positions[index];
+            def.shape = *(*shapes)[index];
+            edyn::make_rigidbody(registry, def);
+        });
 
         // Collision events example.
-        m_registry->on_construct<edyn::contact_started_tag>().connect<&ExamplePagedTriangleMesh::contactStarted>(*this);
-        m_registry->on_destroy<edyn::contact_point>().connect<&ExamplePagedTriangleMesh::contactPointDestroyed>(*this);
+        EnableContactEvents(*m_registry);
 
         edyn::on_paged_mesh_page_loaded(*m_registry).connect<&PageLoaded>(*m_registry);
     }
 
     void destroyScene() override {
-        m_input->close();
-        m_input.reset();
+        DisableContactEvents(*m_registry);
+        DisablePagePrefetch(*m_registry);
+        DisablePageCache(*m_registry);
+        m_has_terrain = false;
+        m_loader->close();
+        m_loader.reset();
     }
 
 private:
-    std::shared_ptr<edyn::paged_triangle_mesh_file_input_archive> m_input;
+    std::shared_ptr<MappedPageLoader> m_loader;
+    bool m_has_terrain {false};
+    LogRateLimiter m_contact_log_limiter {20, 40};
 };
 
 ENTRY_IMPLEMENT_MAIN(
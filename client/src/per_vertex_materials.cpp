@@ -1,5 +1,5 @@
 #include "edyn_example.hpp"
-#include <edyn/util/shape_io.hpp>
+#include "baked_asset.hpp"
 
 class ExamplePerVertexMaterials : public EdynExample
 {
@@ -15,31 +15,15 @@ public:
     void createScene() override
     {
         // Create floor
-        auto vertices = std::vector<edyn::vector3>{};
-        auto colors = std::vector<edyn::vector3>{};
-        auto indices = std::vector<uint32_t>{};
-        auto scale = edyn::vector3_one;
-        auto rotation = edyn::quaternion_axis_angle({1,0,0}, -edyn::half_pi);
-        edyn::load_tri_mesh_from_obj("../../../edyn-testbed/resources/plane_per_vert.obj",
-                                     vertices, indices, &colors, {0,0,0}, rotation, scale);
+        // The friction and restitution of each vertex are baked from the red
+        // and green channels of the vertex colors.
+        auto trimesh = LoadBakedTriangleMesh("plane_per_vert");
 
-        // Get friction and restitution from vertex colors.
-        EDYN_ASSERT(!colors.empty());
-        auto friction = std::vector<edyn::scalar>{};
-        auto restitution = std::vector<edyn::scalar>{};
-
-        for (auto color : colors) {
-            friction.push_back(color.x);
-            restitution.push_back(color.y);
+        // The boxes would fall forever without the floor.
+        if (!trimesh) {
+            return;
         }
 
-        auto trimesh = std::make_shared<edyn::triangle_mesh>();
-        trimesh->insert_vertices(vertices.begin(), vertices.end());
-        trimesh->insert_indices(indices.begin(), indices.end());
-        trimesh->insert_friction_coefficients(friction.begin(), friction.end());
-        trimesh->insert_restitution_coefficients(restitution.begin(), restitution.end());
-        trimesh->initialize();
-
         auto floor_def = edyn::rigidbody_def();
         floor_def.kind = edyn::rigidbody_kind::rb_static;
         floor_def.shape = edyn::mesh_shape{trimesh};
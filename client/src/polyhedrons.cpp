@@ -1,5 +1,5 @@
 #include "edyn_example.hpp"
-#include <edyn/util/shape_io.hpp>
+#include "baked_asset.hpp"
 
 class ExamplePolyhedrons : public EdynExample
 {
@@ -28,41 +28,43 @@ public:
         dyn_def.material->restitution = 0;
         dyn_def.material->friction = 0.7;
 
-        dyn_def.shape =
-            edyn::load_convex_polyhedrons_from_obj("../../../edyn-testbed/resources/box.obj",
-                                                   edyn::vector3_zero, // position offset
-                                                   edyn::quaternion_identity, // orientation
-                                                   {1.5, 1.8, 2}) // scaling
-                                                   .front().shape;
-        dyn_def.position = {0.0, 0.5, 0.0};
-        dyn_def.orientation = edyn::quaternion_axis_angle(edyn::normalize(edyn::vector3{0, 0, 1}), edyn::pi * -0.5);
-        edyn::make_rigidbody(*m_registry, dyn_def);
+        // Box scaled by {1.5, 1.8, 2}.
+        if (auto shape = LoadBakedPolyhedron("box_stretched")) {
+            dyn_def.shape = *shape;
+            dyn_def.position = {0.0, 0.5, 0.0};
+            dyn_def.orientation = edyn::quaternion_axis_angle(edyn::normalize(edyn::vector3{0, 0, 1}), edyn::pi * -0.5);
+            edyn::make_rigidbody(*m_registry, dyn_def);
+        }
 
-        dyn_def.shape = edyn::load_convex_polyhedrons_from_obj("../../../edyn-testbed/resources/cylinder.obj").front().shape;
-        dyn_def.position = {-0., 1.2, 0.0};
-        dyn_def.orientation = edyn::quaternion_axis_angle(edyn::normalize(edyn::vector3{2, 0.6, 1}), edyn::pi * -0.667);
-        edyn::make_rigidbody(*m_registry, dyn_def);
+        if (auto shape = LoadBakedPolyhedron("cylinder")) {
+            dyn_def.shape = *shape;
+            dyn_def.position = {-0., 1.2, 0.0};
+            dyn_def.orientation = edyn::quaternion_axis_angle(edyn::normalize(edyn::vector3{2, 0.6, 1}), edyn::pi * -0.667);
+            edyn::make_rigidbody(*m_registry, dyn_def);
+        }
 
-        dyn_def.shape = edyn::load_compound_shape_from_obj("../../../edyn-testbed/resources/chain_link.obj");
-        dyn_def.position = {-0., 1.8, 0.0};
-        dyn_def.orientation = edyn::quaternion_identity;
-        edyn::make_rigidbody(*m_registry, dyn_def);
+        if (auto shape = LoadBakedCompound("chain_link")) {
+            dyn_def.shape = *shape;
+            dyn_def.position = {-0., 1.8, 0.0};
+            dyn_def.orientation = edyn::quaternion_identity;
+            edyn::make_rigidbody(*m_registry, dyn_def);
+        }
 
-        dyn_def.shape =
-            edyn::load_convex_polyhedrons_from_obj("../../../edyn-testbed/resources/rock.obj",
-                                   edyn::vector3_zero, // position offset
-                                   edyn::quaternion_identity, // orientation
-                                   {1.1, 0.9, 1.3}) // scaling
-                                   .front().shape;
-        dyn_def.position = {0.0, 2.3, 0.0};
-        dyn_def.orientation = edyn::quaternion_identity;
-        edyn::make_rigidbody(*m_registry, dyn_def);
+        // Rock scaled by {1.1, 0.9, 1.3}.
+        if (auto shape = LoadBakedPolyhedron("rock_wide")) {
+            dyn_def.shape = *shape;
+            dyn_def.position = {0.0, 2.3, 0.0};
+            dyn_def.orientation = edyn::quaternion_identity;
+            edyn::make_rigidbody(*m_registry, dyn_def);
+        }
 
-        dyn_def.shape = edyn::load_convex_polyhedrons_from_obj("../../../edyn-testbed/resources/box_subdiv.obj").front().shape;
-        dyn_def.mass = 255;
-        dyn_def.position = {2, 1, 0.0};
-        dyn_def.orientation = edyn::quaternion_axis_angle(edyn::vector3{0, 0, 1}, edyn::pi * -0.667);
-        edyn::make_rigidbody(*m_registry, dyn_def);
+        if (auto shape = LoadBakedPolyhedron("box_subdiv")) {
+            dyn_def.shape = *shape;
+            dyn_def.mass = 255;
+            dyn_def.position = {2, 1, 0.0};
+            dyn_def.orientation = edyn::quaternion_axis_angle(edyn::vector3{0, 0, 1}, edyn::pi * -0.667);
+            edyn::make_rigidbody(*m_registry, dyn_def);
+        }
     }
 };
 
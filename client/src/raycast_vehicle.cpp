@@ -0,0 +1,147 @@
+#include "edyn_example.hpp"
+#include "vehicle_system.hpp"
+#include "raycast_vehicle_system.hpp"
+#include <edyn/replication/register_external.hpp>
+
+void UpdateRaycastVehiclesWithActions(entt::registry &registry) {
+    ProcessVehicleActions(registry);
+    UpdateRaycastVehicles(registry);
+}
+
+class ExampleRaycastVehicle : public EdynExample
+{
+public:
+    ExampleRaycastVehicle(const char* _name, const char* _description, const char* _url)
+        : EdynExample(_name, _description, _url)
+    {
+
+    }
+
+    void createScene() override
+    {
+        RegisterVehicleComponents(*m_registry);
+        edyn::set_pre_step_callback(*m_registry, &UpdateRaycastVehiclesWithActions);
+
+        m_fixed_dt_ms = 8;
+
+        // Create floor
+        auto floor_def = edyn::rigidbody_def();
+        floor_def.kind = edyn::rigidbody_kind::rb_static;
+        floor_def.material->restitution = 0.3;
+        floor_def.material->friction = 1;
+        floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+        edyn::make_rigidbody(*m_registry, floor_def);
+
+        m_vehicle_entity = CreateRaycastVehicle(*m_registry);
+
+        // Traffic driving in circles of different radii.
+        for (int i = 0; i < 8; ++i) {
+            for (int j = 0; j < 8; ++j) {
+                auto position = edyn::vector3{(i - 4) * edyn::scalar(12), 2, (j + 1) * edyn::scalar(12)};
+                auto entity = CreateRaycastVehicle(*m_registry, position);
+                auto &list = m_registry->get<VehicleActionList>(entity);
+                list.actions.push_back(VehicleAction{VehicleThrottleAction{edyn::scalar(0.3)}});
+                list.actions.push_back(VehicleAction{VehicleSteeringAction{edyn::scalar((i + j) % 5) * edyn::scalar(0.1) - edyn::scalar(0.2)}});
+            }
+        }
+    }
+
+    void destroyScene() override {
+        EdynExample::destroyScene();
+        edyn::remove_external_components(*m_registry);
+        edyn::set_pre_step_callback(*m_registry, nullptr);
+    }
+
+    void drawCustom(DebugDrawEncoder &dde) override {
+        auto view = m_registry->view<RaycastVehicle, RaycastVehicleSettings, VehicleState>();
+
+        dde.push();
+        dde.setColor(0xff202020);
+
+        for (auto [entity, vehicle, rc_settings, state] : view.each()) {
+            auto &pos = m_registry->get<edyn::present_position>(vehicle.chassis_entity);
+            auto &orn = m_registry->get<edyn::present_orientation>(vehicle.chassis_entity);
+
+            for (int i = 0; i < 4; ++i) {
+                auto mount = rc_settings.mount_position[i];
+                auto center = edyn::to_world_space(mount - edyn::vector3{0, vehicle.suspension_length[i], 0}, pos, orn);
+                auto wheel_orn = orn *
+                    edyn::quaternion_axis_angle({0, 1, 0}, GetWheelSteering(state, i)) *
+                    edyn::quaternion_axis_angle({1, 0, 0}, vehicle.spin_angle[i]);
+                auto axis = edyn::quaternion_x(wheel_orn) * edyn::scalar(0.15);
+                auto spoke = edyn::rotate(wheel_orn, edyn::vector3{0, rc_settings.wheel_radius, 0});
+
+                dde.drawCylinder(to_bx(center - axis), to_bx(center + axis), rc_settings.wheel_radius);
+                dde.moveTo(to_bx(center + axis * edyn::scalar(1.1)));
+                dde.lineTo(to_bx(center + axis * edyn::scalar(1.1) + spoke));
+            }
+        }
+
+        dde.pop();
+    }
+
+    void insertAction(VehicleAction action) {
+        m_registry->patch<VehicleActionList>(m_vehicle_entity, [&](VehicleActionList &list) {
+            list.actions.push_back(action);
+        });
+
+        edyn::wake_up_entity(*m_registry, m_vehicle_entity);
+    }
+
+    void setSteering(float steering) {
+        if (m_steering != steering) {
+            m_steering = steering;
+            insertAction(VehicleAction{VehicleSteeringAction{steering}});
+        }
+    }
+
+    void setThrottle(float throttle) {
+        if (m_throttle != throttle) {
+            m_throttle = throttle;
+            insertAction(VehicleAction{VehicleThrottleAction{throttle}});
+        }
+    }
+
+    void setBrakes(float brakes) {
+        if (m_brakes != brakes) {
+            m_brakes = brakes;
+            insertAction(VehicleAction{VehicleBrakeAction{brakes}});
+        }
+    }
+
+    void updatePhysics(float deltaTime) override {
+        if (inputGetKeyState(entry::Key::Left)) {
+            setSteering(-1);
+        } else if (inputGetKeyState(entry::Key::Right)) {
+            setSteering(1);
+        } else {
+            setSteering(0);
+        }
+
+        if (inputGetKeyState(entry::Key::Up)) {
+            setThrottle(1);
+        } else {
+            setThrottle(0);
+        }
+
+        if (inputGetKeyState(entry::Key::Down)) {
+            setBrakes(1);
+        } else {
+            setBrakes(0);
+        }
+
+        EdynExample::updatePhysics(deltaTime);
+    }
+
+    entt::entity m_vehicle_entity;
+    edyn::scalar m_steering{};
+    edyn::scalar m_throttle{};
+    edyn::scalar m_brakes{};
+};
+
+ENTRY_IMPLEMENT_MAIN(
+    ExampleRaycastVehicle
+    , "34-raycast-vehicle"
+    , "Single body vehicles with raycast wheels."
+    , "https://github.com/xissburg/edyn"
+    );
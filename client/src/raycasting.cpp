@@ -1,6 +1,6 @@
 #include "edyn_example.hpp"
+#include "baked_asset.hpp"
 #include <edyn/util/shape_util.hpp>
-#include <edyn/util/shape_io.hpp>
 
 class ExampleRaycasting : public EdynExample
 {
@@ -71,18 +71,17 @@ public:
             edyn::capsule_shape{0.15, 0.2, edyn::coordinate_axis::z},
             edyn::vector3{1.6, 1, 0});
 
-        shapes_and_positions.emplace_back(
-            edyn::load_convex_polyhedrons_from_obj("../../../edyn-testbed/resources/rock.obj",
-                                                   {0,0,0}, {0,0,0,1}, {0.8,0.9,1.1}).front().shape,
-            edyn::vector3{2.1, 0.9, 0});
+        if (auto shape = LoadBakedPolyhedron("rock_scaled")) {
+            shapes_and_positions.emplace_back(*shape, edyn::vector3{2.1, 0.9, 0});
+        }
 
-        shapes_and_positions.emplace_back(
-            edyn::load_compound_shape_from_obj("../../../edyn-testbed/resources/chain_link.obj"),
-            edyn::vector3{2.5, 1, 0});
+        if (auto shape = LoadBakedCompound("chain_link")) {
+            shapes_and_positions.emplace_back(*shape, edyn::vector3{2.5, 1, 0});
+        }
 
-        shapes_and_positions.emplace_back(
-            edyn::load_convex_polyhedrons_from_obj("../../../edyn-testbed/resources/cylinder.obj").front().shape,
-            edyn::vector3{-0.1, 0.9, 0.5});
+        if (auto shape = LoadBakedPolyhedron("cylinder")) {
+            shapes_and_positions.emplace_back(*shape, edyn::vector3{-0.1, 0.9, 0.5});
+        }
 
         for (auto [shape, pos] : shapes_and_positions) {
             def.position = pos;
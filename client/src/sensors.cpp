@@ -1,29 +1,12 @@
 #include "edyn_example.hpp"
-#include <edyn/collision/contact_point.hpp>
+#include "contact_events.hpp"
+#include <edyn/collision/contact_manifold.hpp>
 #include <edyn/comp/tag.hpp>
 
-static void SensorContactStarted(entt::registry &registry, entt::entity entity) {
-    auto &cp_list = registry.get<edyn::contact_point_list>(entity);
-    auto &manifold = registry.get<edyn::contact_manifold>(cp_list.parent);
-
-    for (auto body : manifold.body) {
-        if (auto *color = registry.try_get<ColorComponent>(body)) {
-            color->value = 0x80ffffff;
-        }
-    }
-}
-
-static void SensorContactEnded(entt::registry &registry, entt::entity entity) {
-    auto &cp_list = registry.get<edyn::contact_point_list>(entity);
-    auto &manifold_state = registry.get<edyn::contact_manifold_state>(cp_list.parent);
-
-    if (manifold_state.num_points > 0) return;
-
-    auto &manifold = registry.get<edyn::contact_manifold>(cp_list.parent);
-
-    for (auto body : manifold.body) {
+static void SetBodyColors(entt::registry &registry, const ContactEvent &event, uint32_t value) {
+    for (auto body : event.body) {
         if (auto *color = registry.try_get<ColorComponent>(body)) {
-            color->value = 0x80000000;
+            color->value = value;
         }
     }
 }
@@ -73,8 +56,28 @@ public:
         m_registry->emplace<edyn::collide_boolean_test_tag>(sensor_ent);
         m_registry->emplace<ColorComponent>(sensor_ent, 0x80000000);
 
-        m_registry->on_construct<edyn::contact_started_tag>().connect<&SensorContactStarted>();
-        m_registry->on_destroy<edyn::contact_point_list>().connect<&SensorContactEnded>();
+        EnableContactEvents(*m_registry);
+    }
+
+    void destroyScene() override {
+        DisableContactEvents(*m_registry);
+    }
+
+    void updatePhysics(float deltaTime) override {
+        EdynExample::updatePhysics(deltaTime);
+
+        for (auto &event : PollContactEvents(*m_registry)) {
+            if (event.type == ContactEventType::Started) {
+                SetBodyColors(*m_registry, event, 0x80ffffff);
+            } else if (event.type == ContactEventType::Ended) {
+                // Keep highlighted while there are other points.
+                auto *manifold_state = m_registry->try_get<edyn::contact_manifold_state>(event.manifold_entity);
+
+                if (manifold_state == nullptr || manifold_state->num_points == 0) {
+                    SetBodyColors(*m_registry, event, 0x80000000);
+                }
+            }
+        }
     }
 };
 
@@ -1,9 +1,9 @@
 #include "edyn_example.hpp"
+#include "baked_asset.hpp"
+#include "shape_swap.hpp"
 #include <edyn/comp/tag.hpp>
-#include <edyn/dynamics/moment_of_inertia.hpp>
 #include <edyn/shapes/shapes.hpp>
 #include <edyn/util/rigidbody.hpp>
-#include <edyn/util/shape_io.hpp>
 #include <edyn/util/shape_util.hpp>
 #include <random>
 
@@ -23,9 +23,12 @@ public:
         m_shapes.push_back(edyn::sphere_shape{0.2});
         m_shapes.push_back(edyn::box_shape{0.2, 0.2, 0.2});
         m_shapes.push_back(edyn::cylinder_shape{0.2, 0.2, edyn::coordinate_axis::y});
-        m_shapes.push_back(edyn::load_convex_polyhedrons_from_obj("../../../edyn-testbed/resources/box.obj").front().shape);
-        m_shapes.push_back(edyn::load_convex_polyhedrons_from_obj("../../../edyn-testbed/resources/rock.obj").front().shape);
-        m_shapes.push_back(edyn::load_convex_polyhedrons_from_obj("../../../edyn-testbed/resources/cylinder.obj").front().shape);
+
+        for (auto name : {"box", "rock", "cylinder"}) {
+            if (auto shape = LoadBakedPolyhedron(name)) {
+                m_shapes.push_back(*shape);
+            }
+        }
 
         // Create floor
         auto extent_x = 25;
@@ -86,16 +89,12 @@ public:
         if (m_timer > 3) {
             m_timer = 0;
 
-            std::random_device rand_dev;
-            std::mt19937 generator(rand_dev());
             std::uniform_int_distribution<int> distr(0, m_shapes.size() - 1);
-            auto &shape = m_shapes[distr(generator)];
-            auto inertia = edyn::moment_of_inertia(shape, 10);
+            auto &shape = m_shapes[distr(m_generator)];
 
-            for (auto entity : m_registry->view<edyn::dynamic_tag>()) {
-                edyn::rigidbody_set_shape(*m_registry, entity, shape);
-                edyn::set_rigidbody_inertia(*m_registry, entity, inertia);
-            }
+            auto view = m_registry->view<edyn::dynamic_tag>();
+            m_bodies.assign(view.begin(), view.end());
+            SetRigidBodiesShape(*m_registry, m_bodies.data(), m_bodies.size(), shape);
         }
 
         EdynExample::updatePhysics(deltaTime);
@@ -103,6 +102,8 @@ public:
 
     float m_timer {};
     std::vector<edyn::shapes_variant_t> m_shapes;
+    std::vector<entt::entity> m_bodies;
+    std::mt19937 m_generator {std::random_device{}()};
 };
 
 ENTRY_IMPLEMENT_MAIN(
@@ -1,9 +1,27 @@
 #include "edyn_example.hpp"
+#include "adaptive_grain.hpp"
 #include <taskflow/core/declarations.hpp>
 #include <taskflow/taskflow.hpp>
 #include <taskflow/algorithm/for_each.hpp>
 
 tf::Executor *g_executor {nullptr};
+static AdaptiveGrainController *g_grain_controller {nullptr};
+
+// Split the range in chunks of the size chosen by the grain controller and
+// accumulate the time spent in each chunk into the sample.
+static tf::Task emplaceChunks(tf::Taskflow &taskflow, edyn::task_delegate_t task,
+                              std::shared_ptr<AdaptiveGrainController::Sample> sample) {
+    auto size = sample->size;
+    auto grain = sample->grain;
+    auto num_chunks = (size + grain - 1) / grain;
+
+    return taskflow.for_each_index(0u, num_chunks, 1u, [task, sample, size, grain](unsigned i) {
+        auto start = AdaptiveGrainController::clock::now();
+        auto first = i * grain;
+        task(first, std::min(first + grain, size));
+        sample->addBusyTime(start);
+    });
+}
 
 class ExampleTaskflow : public EdynExample
 {
@@ -16,6 +34,7 @@ public:
     void init(int32_t _argc, const char* const* _argv, uint32_t _width, uint32_t _height) override
     {
         g_executor = new tf::Executor;
+        g_grain_controller = new AdaptiveGrainController(g_executor->num_workers());
         EdynExample::init(_argc, _argv, _width, _height);
     }
 
@@ -24,6 +43,8 @@ public:
         auto ret = EdynExample::shutdown();
         delete g_executor;
         g_executor = nullptr;
+        delete g_grain_controller;
+        g_grain_controller = nullptr;
         return ret;
     }
 
@@ -32,26 +53,41 @@ public:
         auto config = edyn::init_config{};
         config.execution_mode = edyn::execution_mode::asynchronous;
         config.enqueue_task = [](edyn::task_delegate_t task, unsigned size, edyn::task_completion_delegate_t completion) {
+            auto sample = std::make_shared<AdaptiveGrainController::Sample>();
+            g_grain_controller->begin(*sample, size);
+
             tf::Taskflow taskflow;
-            auto taskA = taskflow.for_each_index(0u, size, 1u, [task](unsigned i) {
-                task(i, i + 1);
-            });
+            auto taskA = emplaceChunks(taskflow, task, sample);
 
-            if (completion) {
-                auto taskB = taskflow.emplace([completion]() { completion(); });
-                taskA.precede(taskB);
-            }
+            auto taskB = taskflow.emplace([completion, sample]() {
+                g_grain_controller->end(*sample);
+
+                if (completion) {
+                    completion();
+                }
+            });
+            taskA.precede(taskB);
 
             g_executor->run(std::move(taskflow));
         };
         config.enqueue_task_wait = [](edyn::task_delegate_t task, unsigned size) {
+            auto sample = std::make_shared<AdaptiveGrainController::Sample>();
+            g_grain_controller->begin(*sample, size);
+
             tf::Taskflow taskflow;
-            taskflow.for_each_index(0u, size, 1u, [task](unsigned i) { task(i, i + 1); });
+            emplaceChunks(taskflow, task, sample);
             g_executor->run(taskflow).wait();
+
+            g_grain_controller->end(*sample);
         };
         EdynExample::initEdyn(config);
     }
 
+    void showCustomProfiling() override
+    {
+        showGrainProfiling("Task grain", *g_grain_controller);
+    }
+
     void createScene() override
     {
         // Create floor
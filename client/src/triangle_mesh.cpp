@@ -1,10 +1,11 @@
 #include "edyn_example.hpp"
+#include "async_log.hpp"
+#include "baked_asset.hpp"
+#include "contact_events.hpp"
 #include <edyn/collision/contact_point.hpp>
 #include <edyn/comp/tag.hpp>
-#include <edyn/serialization/file_archive.hpp>
 #include <edyn/util/contact_manifold_util.hpp>
-#include <edyn/util/shape_io.hpp>
-#include <iostream>
+#include <optional>
 
 class ExampleTriangleMesh : public EdynExample
 {
@@ -18,92 +19,91 @@ public:
     virtual ~ExampleTriangleMesh() {}
 
     std::vector<entt::entity> m_newContactEntities;
-
-    void contactStarted(entt::registry &registry, entt::entity entity) {
-        auto &cp_imp = registry.get<edyn::contact_point_impulse>(entity);
-        auto normal_impulse = cp_imp.normal_impulse + cp_imp.normal_restitution_impulse;
-        std::cout << "Started | impulse: " << normal_impulse << std::endl;
-    }
-
-    void contactPointDestroyed(entt::registry &registry, entt::entity entity) {
-        auto &cp = registry.get<edyn::contact_point>(entity);
-        auto lifetime = cp.lifetime;
-        std::cout << "Ended | lifetime: " << lifetime << std::endl;
+    LogRateLimiter m_contact_log_limiter {20, 40};
+
+    void updatePhysics(float deltaTime) override {
+        EdynExample::updatePhysics(deltaTime);
+
+        for (auto &event : PollContactEvents(*m_registry)) {
+            switch (event.type) {
+            case ContactEventType::Started:
+                Log(m_contact_log_limiter, "Started | impulse: %f", event.normal_impulse);
+                break;
+            case ContactEventType::Ended:
+                Log(m_contact_log_limiter, "Ended | lifetime: %u", event.lifetime);
+                break;
+            default:
+                break;
+            }
+        }
     }
 
     void createScene() override {
-        // Create floor
-        auto floor_def = edyn::rigidbody_def();
-        floor_def.kind = edyn::rigidbody_kind::rb_static;
-        floor_def.material->restitution = 0;
-        floor_def.material->friction = 0.8;
-
-        auto trimesh = std::make_shared<edyn::triangle_mesh>();
-        auto input = edyn::file_input_archive("terrain.bin");
-
-        if (input.is_file_open()) {
-            edyn::serialize(input, *trimesh);
-        } else {
-            // If binary is not found, load obj then export binary.
-            auto vertices = std::vector<edyn::vector3>{};
-            auto indices = std::vector<uint32_t>{};
-            auto scale = edyn::scalar(0.1) * edyn::vector3_one;
-            edyn::load_tri_mesh_from_obj("../../../edyn-testbed/resources/terrain.obj",
-                                         vertices, indices, nullptr, {0,0,0}, {0,0,0,1}, scale);
-            trimesh->insert_vertices(vertices.begin(), vertices.end());
-            trimesh->insert_indices(indices.begin(), indices.end());
-            trimesh->initialize();
-            auto output = edyn::file_output_archive("terrain.bin");
-            edyn::serialize(output, *trimesh);
-        }
+        // Terrain scaled down by 10.
+        auto trimesh = std::make_shared<std::shared_ptr<edyn::triangle_mesh>>();
+        auto positions = std::vector<edyn::vector3>{
+            {0, 1, 0}, {0.5, 1, 0}, {1.1, 0.9, 0}, {1.6, 1, 0}, {2.1, 0.9, 0}, {2.5, 1, 0}
+        };
+        // One shape per position. Shapes which failed to load are left empty
+        // so only their own body is skipped.
+        auto shapes = std::make_shared<std::vector<std::optional<edyn::shapes_variant_t>>>(positions.size());
+
+        m_scene_builder.load("Loading terrain", [trimesh] {
+            *trimesh = LoadBakedTriangleMesh("terrain");
+        });
+
+        m_scene_builder.load("Loading shapes", [shapes] {
+            (*shapes)[0] = edyn::cylinder_shape{0.15, 0.2, edyn::coordinate_axis::z};
+            (*shapes)[1] = edyn::sphere_shape{0.2};
+            (*shapes)[2] = edyn::box_shape{0.2, 0.15, 0.25};
+            (*shapes)[3] = edyn::capsule_shape{0.15, 0.2};
+
+            if (auto shape = LoadBakedPolyhedron("rock_scaled")) {
+                (*shapes)[4] = *shape;
+            }
+
+            if (auto shape = LoadBakedCompound("chain_link")) {
+                (*shapes)[5] = *shape;
+            }
+        });
 
-        floor_def.shape = edyn::mesh_shape{trimesh};
-        edyn::make_rigidbody(*m_registry, floor_def);
+        m_scene_builder.build("Creating terrain", [trimesh](entt::registry &registry) {
+            if (!*trimesh) {
+                return;
+            }
+
+            // Create floor
+            auto floor_def = edyn::rigidbody_def();
+            floor_def.kind = edyn::rigidbody_kind::rb_static;
+            floor_def.material->restitution = 0;
+            floor_def.material->friction = 0.8;
+            floor_def.shape = edyn::mesh_shape{*trimesh};
+            edyn::make_rigidbody(registry, floor_def);
+        });
+
+        m_scene_builder.staticWorldReady();
+
+        // Add some dynamic entities, one per shape.
+        m_scene_builder.buildBatched("Creating bodies", positions.size(), [shapes, positions](entt::registry &registry, size_t index) {
+            if (!(*shapes)[index]) {
+                return;
+            }
 
-        // Add some dynamic entities.
-        {
             auto def = edyn::rigidbody_def();
             def.mass = 50;
             def.material->friction = 0.4;
             def.material->restitution = 0;
-
-            auto shapes_and_positions = std::vector<std::pair<edyn::shapes_variant_t, edyn::vector3>>{};
-
-            shapes_and_positions.emplace_back(
-                edyn::cylinder_shape{0.15, 0.2, edyn::coordinate_axis::z},
-                edyn::vector3{0, 1, 0});
-
-            shapes_and_positions.emplace_back(
-                edyn::sphere_shape{0.2},
-                edyn::vector3{0.5, 1, 0});
-
-            shapes_and_positions.emplace_back(
-                edyn::box_shape{0.2, 0.15, 0.25},
-                edyn::vector3{1.1, 0.9, 0});
-
-            shapes_and_positions.emplace_back(
-                edyn::capsule_shape{0.15, 0.2},
-                edyn::vector3{1.6, 1, 0});
-
-            shapes_and_positions.emplace_back(
-                edyn::load_convex_polyhedrons_from_obj("../../../edyn-testbed/resources/rock.obj",
-                                                       {0,0,0}, {0,0,0,1}, {0.8,0.9,1.1}).front().shape,
-                edyn::vector3{2.1, 0.9, 0});
-
-            shapes_and_positions.emplace_back(
-                edyn::load_compound_shape_from_obj("../../../edyn-testbed/resources/chain_link.obj"),
-                edyn::vector3{2.5, 1, 0});
-
-            for (auto [shape, pos] : shapes_and_positions) {
-                def.position = pos;
-                def.shape = shape;
-                edyn::make_rigidbody(*m_registry, def);
-            }
-        }
+            def.position = positions[index];
+            def.shape = *(*shapes)[index];
+            edyn::make_rigidbody(registry, def);
+        });
 
         // Collision events example.
-        m_registry->on_construct<edyn::contact_started_tag>().connect<&ExampleTriangleMesh::contactStarted>(*this);
-        m_registry->on_destroy<edyn::contact_point>().connect<&ExampleTriangleMesh::contactPointDestroyed>(*this);
+        EnableContactEvents(*m_registry);
+    }
+
+    void destroyScene() override {
+        DisableContactEvents(*m_registry);
     }
 };
 
@@ -0,0 +1,119 @@
+#include "edyn_example.hpp"
+#include "rigidbody_batch.hpp"
+#include "trigger_volume.hpp"
+
+void CountTriggerEvents(size_t &num_events, const TriggerEvent *events, size_t count) {
+    num_events += count;
+}
+
+class ExampleTriggerVolumes : public EdynExample
+{
+public:
+    ExampleTriggerVolumes(const char* _name, const char* _description, const char* _url)
+        : EdynExample(_name, _description, _url)
+    {
+
+    }
+
+    void createScene() override
+    {
+        // Create floor
+        auto floor_def = edyn::rigidbody_def();
+        floor_def.kind = edyn::rigidbody_kind::rb_static;
+        floor_def.material->restitution = 0;
+        floor_def.material->friction = 0.8;
+        floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+        edyn::make_rigidbody(*m_registry, floor_def);
+
+        // A field of triggers alternating between boxes and spheres.
+        auto volume = TriggerVolume{};
+        volume.half_extents = {0.4, 0.4, 0.4};
+        volume.radius = 0.45;
+
+        for (int i = 0; i < 40; ++i) {
+            for (int j = 0; j < 40; ++j) {
+                volume.shape = (i + j) % 2 == 0 ? TriggerShape::Box : TriggerShape::Sphere;
+                volume.position = {edyn::scalar(i - 20), edyn::scalar(0.4), edyn::scalar(j - 20)};
+                volume.orientation = edyn::quaternion_axis_angle({0, 1, 0}, edyn::scalar(i * j) * edyn::scalar(0.1));
+                CreateTriggerVolume(*m_registry, volume);
+            }
+        }
+
+        // Bodies falling through the triggers.
+        auto def = edyn::rigidbody_def();
+        def.material->friction = 0.8;
+        def.material->restitution = 0.2;
+        def.mass = 10;
+
+        auto defs = std::vector<edyn::rigidbody_def>{};
+
+        for (int i = 0; i < 10; ++i) {
+            for (int j = 0; j < 10; ++j) {
+                def.shape = (i + j) % 2 == 0 ? edyn::shapes_variant_t{edyn::box_shape{0.2, 0.2, 0.2}}
+                                             : edyn::shapes_variant_t{edyn::sphere_shape{0.2}};
+                def.position = {edyn::scalar(i * 3 - 15), edyn::scalar(3 + (i + j) % 4), edyn::scalar(j * 3 - 15)};
+                def.linvel = {edyn::scalar((j % 3) - 1), 0, edyn::scalar((i % 3) - 1)};
+                defs.push_back(def);
+            }
+        }
+
+        MakeRigidBodies(*m_registry, defs.data(), defs.size());
+    }
+
+    void updatePhysics(float deltaTime) override {
+        EdynExample::updatePhysics(deltaTime);
+
+        auto start = edyn::performance_time();
+        auto delegate = TriggerEventDelegate(entt::connect_arg_t<&CountTriggerEvents>{}, m_num_events);
+        UpdateTriggerVolumes(*m_registry, delegate);
+        m_update_time = edyn::performance_time() - start;
+    }
+
+    void showCustomProfiling() override {
+        ImGui::LabelText("Triggers", "%.3f", 1e3 * m_update_time);
+        ImGui::LabelText("Trigger events", "%zu", m_num_events);
+    }
+
+    void drawCustom(DebugDrawEncoder &dde) override {
+        auto view = m_registry->view<TriggerVolume>();
+
+        dde.push();
+        dde.setWireframe(true);
+
+        for (auto [entity, volume] : view.each()) {
+            auto overlaps = GetTriggerOverlaps(*m_registry, entity);
+            dde.setColor(overlaps.count > 0 ? 0xff00ff00 : 0x40ffffff);
+
+            float rot[16];
+            bx::mtxQuat(rot, to_bx(volume.orientation));
+            float rotT[16];
+            bx::mtxTranspose(rotT, rot);
+            float trans[16];
+            bx::mtxTranslate(trans, volume.position.x, volume.position.y, volume.position.z);
+            float mtx[16];
+            bx::mtxMul(mtx, rotT, trans);
+            dde.pushTransform(mtx);
+
+            if (volume.shape == TriggerShape::Box) {
+                draw(dde, edyn::box_shape{volume.half_extents});
+            } else {
+                draw(dde, edyn::sphere_shape{volume.radius});
+            }
+
+            dde.popTransform();
+        }
+
+        dde.pop();
+    }
+
+private:
+    size_t m_num_events {};
+    double m_update_time {};
+};
+
+ENTRY_IMPLEMENT_MAIN(
+    ExampleTriggerVolumes
+    , "37-trigger-volumes"
+    , "Trigger volumes without contact processing."
+    , "https://github.com/xissburg/edyn-testbed"
+    );
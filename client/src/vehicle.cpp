@@ -35,6 +35,24 @@ public:
         edyn::set_pre_step_callback(*m_registry, nullptr);
     }
 
+    void showCustomSettings() override {
+        static const char *modes[] = {"Serial", "Batched", "Parallel"};
+
+        if (ImGui::Combo("Vehicle update", &m_update_mode, modes, 3)) {
+            switch (m_update_mode) {
+            case 0:
+                edyn::set_pre_step_callback(*m_registry, &UpdateVehicles);
+                break;
+            case 1:
+                edyn::set_pre_step_callback(*m_registry, &UpdateVehiclesBatched);
+                break;
+            case 2:
+                edyn::set_pre_step_callback(*m_registry, &UpdateVehiclesParallel);
+                break;
+            }
+        }
+    }
+
     void insertAction(VehicleAction action) {
         m_registry->patch<VehicleActionList>(m_vehicle_entity, [&](VehicleActionList &list) {
             list.actions.push_back(action);
@@ -92,6 +110,7 @@ public:
     }
 
     entt::entity m_vehicle_entity;
+    int m_update_mode {};
     edyn::scalar m_steering{};
     edyn::scalar m_throttle{};
     edyn::scalar m_brakes{};
@@ -1,6 +1,7 @@
 #include "networking.hpp"
 #include "server_ports.hpp"
 #include "vehicle_system.hpp"
+#include "raycast_vehicle_system.hpp"
 #include "pick_input.hpp"
 #include <edyn/networking/networking.hpp>
 #include <edyn/networking/sys/client_side.hpp>
@@ -8,7 +9,8 @@
 
 void PreStepUpdate(entt::registry &registry) {
     UpdatePickInput(registry);
-    UpdateVehicles(registry);
+    UpdateVehiclesBatched(registry);
+    UpdateRaycastVehicles(registry);
 }
 
 class ExampleVehicleNetworking;
@@ -105,14 +107,20 @@ void OnEntityEnteredVehicle(ExampleVehicleNetworking &example, entt::entity asse
     auto &registry = *example.m_registry;
     auto &asset = registry.get<edyn::asset_ref>(asset_entity);
 
+    auto vehicleEntity = entt::entity{entt::null};
+
     if (asset.id == VehicleAssetID) {
-        auto vehicleEntity = CreateVehicle(registry);
+        vehicleEntity = CreateVehicle(registry);
         auto emap = CreateVehicleAssetEntityMap(registry, vehicleEntity);
         edyn::client_link_asset(registry, asset_entity, emap);
+    } else if (asset.id == RaycastVehicleAssetID) {
+        vehicleEntity = CreateRaycastVehicle(registry);
+        auto emap = CreateRaycastVehicleAssetEntityMap(registry, vehicleEntity);
+        edyn::client_link_asset(registry, asset_entity, emap);
+    }
 
-        if (edyn::client_owns_entity(registry, asset_entity)) {
-            example.m_vehicle_entity = vehicleEntity;
-        }
+    if (vehicleEntity != entt::null && edyn::client_owns_entity(registry, asset_entity)) {
+        example.m_vehicle_entity = vehicleEntity;
     }
 }
 
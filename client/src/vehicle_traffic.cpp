@@ -0,0 +1,109 @@
+#include "edyn_example.hpp"
+#include "vehicle_system.hpp"
+#include "vehicle_lod.hpp"
+#include "raycast_vehicle_system.hpp"
+#include <edyn/replication/register_external.hpp>
+
+void UpdateTrafficVehicles(entt::registry &registry) {
+    UpdateVehicles(registry);
+    UpdateRaycastVehicles(registry);
+}
+
+class ExampleVehicleTraffic : public EdynExample
+{
+public:
+    ExampleVehicleTraffic(const char* _name, const char* _description, const char* _url)
+        : EdynExample(_name, _description, _url)
+    {
+
+    }
+
+    void createScene() override
+    {
+        RegisterVehicleComponents(*m_registry);
+        edyn::set_pre_step_callback(*m_registry, &UpdateTrafficVehicles);
+
+        m_fixed_dt_ms = 8;
+
+        // Create floor
+        auto floor_def = edyn::rigidbody_def();
+        floor_def.kind = edyn::rigidbody_kind::rb_static;
+        floor_def.material->restitution = 0.3;
+        floor_def.material->friction = 1;
+        floor_def.shape = edyn::plane_shape{{0, 1, 0}, 0};
+        edyn::make_rigidbody(*m_registry, floor_def);
+
+        // Traffic driving in circles spread over a large area. Distant
+        // vehicles are simulated with the simplified model.
+        for (int i = 0; i < 12; ++i) {
+            for (int j = 0; j < 12; ++j) {
+                auto position = edyn::vector3{(i - 6) * edyn::scalar(20), 2, (j + 1) * edyn::scalar(20)};
+                auto entity = CreateVehicle(*m_registry, position);
+                MakeVehicleLOD(*m_registry, entity);
+
+                auto &list = m_registry->get<VehicleActionList>(entity);
+                list.actions.push_back(VehicleAction{VehicleThrottleAction{edyn::scalar(0.3)}});
+                list.actions.push_back(VehicleAction{VehicleSteeringAction{edyn::scalar((i + j) % 5) * edyn::scalar(0.1) - edyn::scalar(0.2)}});
+            }
+        }
+    }
+
+    void destroyScene() override {
+        EdynExample::destroyScene();
+        edyn::remove_external_components(*m_registry);
+        edyn::set_pre_step_callback(*m_registry, nullptr);
+    }
+
+    // The level of detail destroys and creates wheels along with their
+    // constraints at runtime, which a snapshot can't bring back.
+    bool canRestoreSnapshot() const override { return false; }
+
+    void updatePhysics(float deltaTime) override {
+        auto cam_pos = edyn::vector3{cameraGetPosition().x, cameraGetPosition().y, cameraGetPosition().z};
+        auto regions = std::vector<edyn::AABB>{{cam_pos, cam_pos}};
+        UpdateVehicleLOD(*m_registry, regions, m_lod_settings);
+
+        EdynExample::updatePhysics(deltaTime);
+    }
+
+    void showCustomSettings() override {
+        ImGui::SliderFloat("Full LOD distance", &m_lod_settings.full_distance, 10, 200, "%.0f");
+        ImGui::SliderFloat("Simplified LOD distance", &m_lod_settings.simplified_distance,
+                           m_lod_settings.full_distance, 250, "%.0f");
+
+        auto num_full = m_registry->view<Vehicle>().size();
+        auto num_simplified = m_registry->view<RaycastVehicle>().size();
+        ImGui::Text("Full: %zu, Simplified: %zu", num_full, num_simplified);
+    }
+
+    void drawCustom(DebugDrawEncoder &dde) override {
+        auto view = m_registry->view<RaycastVehicle, RaycastVehicleSettings, VehicleState>();
+
+        dde.push();
+        dde.setColor(0xff202020);
+
+        for (auto [entity, vehicle, rc_settings, state] : view.each()) {
+            auto &pos = m_registry->get<edyn::present_position>(vehicle.chassis_entity);
+            auto &orn = m_registry->get<edyn::present_orientation>(vehicle.chassis_entity);
+
+            for (int i = 0; i < 4; ++i) {
+                auto mount = rc_settings.mount_position[i];
+                auto center = edyn::to_world_space(mount - edyn::vector3{0, vehicle.suspension_length[i], 0}, pos, orn);
+                auto wheel_orn = orn * edyn::quaternion_axis_angle({0, 1, 0}, GetWheelSteering(state, i));
+                auto axis = edyn::quaternion_x(wheel_orn) * edyn::scalar(0.15);
+                dde.drawCylinder(to_bx(center - axis), to_bx(center + axis), rc_settings.wheel_radius);
+            }
+        }
+
+        dde.pop();
+    }
+
+    VehicleLODSettings m_lod_settings;
+};
+
+ENTRY_IMPLEMENT_MAIN(
+    ExampleVehicleTraffic
+    , "35-vehicle-traffic"
+    , "Vehicle level of detail."
+    , "https://github.com/xissburg/edyn"
+    );
@@ -0,0 +1,53 @@
+#ifndef EDYN_TESTBED_ASYNC_LOG_HPP
+#define EDYN_TESTBED_ASYNC_LOG_HPP
+
+#include <chrono>
+#include <cstdint>
+
+// Lets the compiler check the arguments against the format string.
+#if defined(__GNUC__) || defined(__clang__)
+#define EDYN_TESTBED_PRINTF_FORMAT(format_index, first_arg_index) \
+    __attribute__((format(printf, format_index, first_arg_index)))
+#else
+#define EDYN_TESTBED_PRINTF_FORMAT(format_index, first_arg_index)
+#endif
+
+// Token bucket which allows bursts of up to `burst` messages and `rate`
+// messages per second on average. Not thread-safe, meant to be owned by a
+// single call site.
+class LogRateLimiter {
+public:
+    LogRateLimiter(double rate, double burst);
+
+    // Whether a message can be logged now. Consumes a token if so.
+    bool allow();
+
+    // Number of messages rejected since the last one allowed.
+    uint64_t suppressed() const { return m_suppressed; }
+
+private:
+    using clock = std::chrono::steady_clock;
+
+    double m_rate;
+    double m_burst;
+    double m_tokens;
+    clock::time_point m_last;
+    uint64_t m_suppressed {};
+};
+
+// Formats a message printf-style and queues it to be written to the standard
+// output by a background thread, followed by a new line. Each thread pushes
+// into its own lock-free buffer, thus logging never blocks nor flushes on the
+// calling thread. Messages longer than 255 characters are truncated and
+// messages are dropped if the buffer of the thread is full, in which case
+// the number of dropped messages is logged later.
+void Log(const char *format, ...) EDYN_TESTBED_PRINTF_FORMAT(1, 2);
+
+// Same as above but only if the rate limiter allows it. The number of
+// messages suppressed since the previous one is appended.
+void Log(LogRateLimiter &limiter, const char *format, ...) EDYN_TESTBED_PRINTF_FORMAT(2, 3);
+
+// Writes all queued messages and flushes. Blocks until done.
+void FlushLog();
+
+#endif // EDYN_TESTBED_ASYNC_LOG_HPP
@@ -0,0 +1,64 @@
+#ifndef EDYN_TESTBED_BAKED_ASSET_HPP
+#define EDYN_TESTBED_BAKED_ASSET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <edyn/shapes/compound_shape.hpp>
+#include <edyn/shapes/polyhedron_shape.hpp>
+#include <edyn/shapes/triangle_mesh.hpp>
+
+// Assets under `resources/` are converted into binary blobs ahead of time by
+// the baker in `tools/baker`, so the examples never parse OBJ files at
+// runtime. Paged meshes are baked into a structure file and a page file (see
+// `mapped_page_loader.hpp`) instead.
+
+enum class BakedAssetKind : uint32_t {
+    TriangleMesh,
+    Polyhedron,
+    Compound
+};
+
+struct BakedAssetHeader {
+    static constexpr uint32_t current_version = 1;
+
+    char magic[4] {'E', 'D', 'B', 'K'};
+    uint32_t version {current_version};
+    BakedAssetKind kind;
+    uint32_t reserved {};
+    uint64_t payload_size {};
+    // Checksum of the payload, which follows the header.
+    uint64_t checksum {};
+};
+
+// 64-bit FNV-1a.
+uint64_t ComputeChecksum(const uint8_t *data, size_t size);
+
+// Directory where baked assets are read from, relative to the working
+// directory of the examples, which is bgfx/examples/runtime.
+constexpr const char *baked_asset_directory = "../../../edyn-testbed/resources/baked/";
+constexpr const char *baked_asset_extension = ".edbk";
+
+std::string GetBakedAssetPath(const std::string &name,
+                              const std::string &directory = baked_asset_directory);
+
+bool WriteBakedAsset(const std::string &path, BakedAssetKind kind, const std::vector<uint8_t> &payload);
+
+// Reads the payload and validates magic, version, kind, size and checksum.
+bool ReadBakedAsset(const std::string &path, BakedAssetKind kind, std::vector<uint8_t> &payload);
+
+bool SaveBakedTriangleMesh(const std::string &path, const edyn::triangle_mesh &);
+bool SaveBakedPolyhedron(const std::string &path, const edyn::polyhedron_shape &);
+bool SaveBakedCompound(const std::string &path, const edyn::compound_shape &);
+
+// Load a baked asset by name from the baked asset directory. A missing or
+// invalid asset is logged and nothing is returned, in which case the bodies
+// using it must not be created.
+std::shared_ptr<edyn::triangle_mesh> LoadBakedTriangleMesh(const std::string &name);
+std::optional<edyn::polyhedron_shape> LoadBakedPolyhedron(const std::string &name);
+std::optional<edyn::compound_shape> LoadBakedCompound(const std::string &name);
+
+#endif // EDYN_TESTBED_BAKED_ASSET_HPP
@@ -0,0 +1,54 @@
+#ifndef EDYN_TESTBED_BATCH_RAYCAST_HPP
+#define EDYN_TESTBED_BATCH_RAYCAST_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <edyn/math/vector3.hpp>
+#include <edyn/collision/raycast.hpp>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+#include <entt/signal/delegate.hpp>
+
+struct BatchRay {
+    edyn::vector3 p0;
+    edyn::vector3 p1;
+    // Entities this ray does not hit, usually the body casting it. Unused
+    // slots are null.
+    std::array<entt::entity, 2> ignore {entt::null, entt::null};
+    // Entity casting this ray every step and index of the ray among its
+    // rays. When set, the last hit on a static entity is cached under this
+    // key and tested first in the next steps.
+    entt::entity owner {entt::null};
+    uint32_t owner_index {};
+};
+
+// Casts many rays at once. Rays are sorted along a Morton curve and nearby
+// rays are grouped into clusters which query the broadphase tree once with
+// the union of their bounds, instead of once per ray. Within a cluster,
+// groups of four rays pointing in similar directions are tested against the
+// candidate bounds at once with SIMD slab tests. The closest hit of
+// each ray is written into `results` at the same index, which must have room
+// for `count` elements. Rays that hit nothing have a null entity. Scratch
+// buffers are kept in the registry context and reused between calls.
+//
+// Rays with an owner first test the triangle or shape they hit in the
+// previous step and skip the broadphase entirely if they still hit it. Since
+// that ignores bodies that might have moved in front of the cached hit,
+// cached hits are only reused for a few steps before a full query is forced.
+void BatchRaycast(entt::registry &, const BatchRay *rays, size_t count, edyn::raycast_result *results);
+
+// Receives all rays of a batch along with their results, at the same index.
+using BatchRaycastDelegate = entt::delegate<void(const BatchRay *, const edyn::raycast_result *, size_t)>;
+
+// Same as `BatchRaycast` but clusters are split among the workers of the
+// configured task scheduler when there are enough of them. Workers only read
+// from the registry and each writes the results of its own clusters. Once
+// all rays are done, `delegate` is invoked once on the calling thread with
+// all results, which stay valid until the next call. Must be called from a
+// thread that is allowed to wait on the scheduler, such as the pre-step
+// callback.
+void BatchRaycastParallel(entt::registry &, const BatchRay *rays, size_t count,
+                          BatchRaycastDelegate delegate);
+
+#endif // EDYN_TESTBED_BATCH_RAYCAST_HPP
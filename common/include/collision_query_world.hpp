@@ -0,0 +1,49 @@
+#ifndef EDYN_TESTBED_COLLISION_QUERY_WORLD_HPP
+#define EDYN_TESTBED_COLLISION_QUERY_WORLD_HPP
+
+#include <utility>
+#include <edyn/collision/broadphase.hpp>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+// Read-only access to everything needed to query the world. All views are
+// created on the calling thread before work is dispatched so workers never
+// create storage or otherwise modify the registry.
+struct CollisionQueryWorld {
+    using aabb_view_t = decltype(std::declval<entt::registry &>().view<edyn::AABB>());
+    using index_view_t = decltype(std::declval<entt::registry &>().view<edyn::shape_index>());
+    using tr_view_t = decltype(std::declval<entt::registry &>().view<edyn::position, edyn::orientation>());
+    using origin_view_t = decltype(std::declval<entt::registry &>().view<edyn::origin>());
+    using static_view_t = decltype(std::declval<entt::registry &>().view<edyn::static_tag>());
+    using shape_views_t = decltype(edyn::get_tuple_of_shape_views(std::declval<entt::registry &>()));
+
+    const edyn::broadphase *bphase;
+    aabb_view_t aabb_view;
+    index_view_t index_view;
+    tr_view_t tr_view;
+    origin_view_t origin_view;
+    static_view_t static_view;
+    shape_views_t shape_views_tuple;
+
+    CollisionQueryWorld(entt::registry &registry)
+        : bphase(&registry.ctx().get<edyn::broadphase>())
+        , aabb_view(registry.view<edyn::AABB>())
+        , index_view(registry.view<edyn::shape_index>())
+        , tr_view(registry.view<edyn::position, edyn::orientation>())
+        , origin_view(registry.view<edyn::origin>())
+        , static_view(registry.view<edyn::static_tag>())
+        , shape_views_tuple(edyn::get_tuple_of_shape_views(registry))
+    {}
+
+    // Position of the shape, which is offset from the rigid body position
+    // when the center of mass is shifted.
+    edyn::vector3 getOrigin(entt::entity entity) const {
+        if (origin_view.contains(entity)) {
+            return origin_view.get<edyn::origin>(entity);
+        }
+
+        return tr_view.get<edyn::position>(entity);
+    }
+};
+
+#endif // EDYN_TESTBED_COLLISION_QUERY_WORLD_HPP
@@ -0,0 +1,58 @@
+#ifndef EDYN_TESTBED_CONTACT_EVENTS_HPP
+#define EDYN_TESTBED_CONTACT_EVENTS_HPP
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <edyn/comp/material.hpp>
+#include <edyn/math/vector3.hpp>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+
+enum class ContactEventType {
+    Started,
+    Ended,
+    // Ongoing contact with a normal impulse above the threshold.
+    Impulse
+};
+
+struct ContactEvent {
+    static constexpr auto no_material = std::numeric_limits<edyn::material::id_type>::max();
+
+    ContactEventType type;
+    // The contact point entity, which is not valid anymore in ended events.
+    entt::entity contact_entity {entt::null};
+    entt::entity manifold_entity {entt::null};
+    std::array<entt::entity, 2> body {entt::null, entt::null};
+    // Material id of each body or `no_material` if the body has no material,
+    // as in sensors.
+    std::array<edyn::material::id_type, 2> material_id {no_material, no_material};
+    // Contact point and normal in world space. The point is on the first body.
+    edyn::vector3 point {edyn::vector3_zero};
+    edyn::vector3 normal {edyn::vector3_zero};
+    // Normal impulse including restitution. Zero in ended events.
+    edyn::scalar normal_impulse {};
+    // Number of steps the contact point has been alive.
+    uint32_t lifetime {};
+};
+
+struct ContactEventSettings {
+    // Ongoing contacts with a normal impulse above this generate an impulse
+    // event on every poll. Zero disables impulse events, which avoids going
+    // over all contact points.
+    edyn::scalar impulse_threshold {0};
+};
+
+// Starts recording contact events. The registry signals only record which
+// contacts started or ended, everything else is resolved when polling.
+void EnableContactEvents(entt::registry &, const ContactEventSettings &settings = {});
+void DisableContactEvents(entt::registry &);
+
+// Resolves all events recorded since the last poll and returns them in the
+// order they happened, followed by impulse events. The buffer is reused and
+// stays valid until the next poll. Meant to be called once per frame after
+// updating physics.
+const std::vector<ContactEvent> &PollContactEvents(entt::registry &);
+
+#endif // EDYN_TESTBED_CONTACT_EVENTS_HPP
@@ -0,0 +1,44 @@
+#ifndef EDYN_TESTBED_MAPPED_FILE_HPP
+#define EDYN_TESTBED_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. Pages are only read from storage
+// when first touched and are shared with every other process mapping the
+// same file through the OS page cache.
+class MappedFile {
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    bool open(const std::string &path);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const uint8_t *data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+    // Hints the OS to start reading a range in the background so touching it
+    // later doesn't stall. Does nothing where not supported.
+    void willNeed(size_t offset, size_t length) const;
+
+    // Hints the OS that a range won't be needed soon and its pages can be
+    // reclaimed.
+    void dontNeed(size_t offset, size_t length) const;
+
+private:
+    const uint8_t *m_data {nullptr};
+    size_t m_size {};
+#ifdef _WIN32
+    void *m_file {nullptr};
+    void *m_mapping {nullptr};
+#else
+    int m_fd {-1};
+#endif
+};
+
+#endif // EDYN_TESTBED_MAPPED_FILE_HPP
@@ -0,0 +1,133 @@
+#ifndef EDYN_TESTBED_MAPPED_PAGE_LOADER_HPP
+#define EDYN_TESTBED_MAPPED_PAGE_LOADER_HPP
+
+#include "mapped_file.hpp"
+#include "page_codec.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <edyn/comp/aabb.hpp>
+#include <edyn/context/task.hpp>
+#include <edyn/shapes/paged_triangle_mesh.hpp>
+#include <edyn/shapes/triangle_mesh_page_loader.hpp>
+
+// Layout of a page file. All integers are little endian.
+struct MappedPageFileHeader {
+    static constexpr uint32_t current_version = 6;
+    // Raw pages start at multiples of this so each one begins on its own OS
+    // page and can be faulted in or evicted independently. Encoded pages are
+    // much smaller and are packed more tightly so the padding doesn't undo
+    // the savings.
+    static constexpr uint64_t page_alignment = 4096;
+    static constexpr uint64_t encoded_page_alignment = 16;
+
+    char magic[4] {'E', 'D', 'P', 'G'};
+    uint32_t version {current_version};
+    PageCodec codec {PageCodec::Raw};
+    uint32_t reserved {};
+    uint64_t num_pages {};
+    // Size and checksum of the structure file written by Edyn along with the
+    // page file, which has no header of its own.
+    uint64_t structure_size {};
+    uint64_t structure_checksum {};
+    // Followed by `num_pages` entries.
+};
+
+struct MappedPageEntry {
+    uint64_t offset;
+    uint64_t size;
+    // Checksum of the page bytes, verified when loading.
+    uint64_t checksum;
+    // Bounds of the submesh in object space, which allows deciding what to
+    // load without touching the page itself.
+    float aabb_min[3];
+    float aabb_max[3];
+};
+
+// Writes all submeshes of a paged triangle mesh into a page file, one
+// `triangle_mesh` per page encoded with the given codec. All submeshes must
+// be loaded, which is the case right after `create_paged_triangle_mesh`.
+// The structure file at `structure_path` must have been written already,
+// its size and checksum are recorded in the header.
+bool WriteMappedPageFile(const std::string &path, const std::string &structure_path,
+                         edyn::paged_triangle_mesh &paged_trimesh,
+                         PageCodec codec = PageCodec::Raw,
+                         const PageCodecSettings &codec_settings = {});
+
+// Loads submeshes of a paged triangle mesh from a memory mapped page file.
+// Each submesh is deserialized or decoded straight from the mapping, thus
+// loading costs the page faults to bring it in plus one pass over it,
+// without any read calls or intermediate buffers. The page cache is shared
+// among all processes mapping the file, such as multiple servers on the
+// same host. Pages are loaded in parallel in tasks of the given scheduler.
+class MappedPageLoader : public edyn::triangle_mesh_page_loader_base {
+public:
+    MappedPageLoader(edyn::enqueue_task_t *enqueue_task = nullptr);
+    ~MappedPageLoader();
+
+    // Also verifies the structure file the page file was written with, which
+    // must be done before handing it to Edyn.
+    bool open(const std::string &path, const std::string &structure_path);
+    // Discards pending loads and waits for the ones in progress before
+    // unmapping the file.
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+
+    size_t numPages() const { return m_entries.size(); }
+    PageCodec codec() const { return m_codec; }
+    edyn::AABB pageAABB(size_t index) const;
+
+    // Demand load requested by the paged mesh. Served before prefetches.
+    void load(size_t index) override;
+
+    // Loads a page ahead of time. Does nothing and returns false if the page
+    // is already being loaded. Prefetches are served in the order they are
+    // issued.
+    bool prefetch(size_t index);
+    bool isLoading(size_t index) const;
+
+    // Demand loads of pages that were not being prefetched.
+    uint64_t numMisses() const { return m_num_misses.load(std::memory_order_relaxed); }
+    // Demand loads of pages that were still being prefetched.
+    uint64_t numLateLoads() const { return m_num_late_loads.load(std::memory_order_relaxed); }
+
+    entt::sink<entt::sigh<loaded_mesh_func_t>> on_load_sink() override;
+
+    // Loads the next pending page. Invoked in a background task once per
+    // requested load.
+    void loadPending(unsigned start, unsigned end);
+
+    const MappedFile &file() const { return m_file; }
+    const MappedPageEntry &entry(size_t index) const { return m_entries[index]; }
+
+private:
+    enum class PageState : uint8_t {
+        Idle,
+        Loading,
+        Prefetching
+    };
+
+    void enqueue();
+    void loadPage(size_t index);
+
+    MappedFile m_file;
+    std::vector<MappedPageEntry> m_entries;
+    PageCodec m_codec {PageCodec::Raw};
+    edyn::enqueue_task_t *m_enqueue_task;
+    entt::sigh<loaded_mesh_func_t> m_loaded_mesh_signal;
+    mutable std::mutex m_pending_mutex;
+    std::deque<size_t> m_pending;
+    std::deque<size_t> m_pending_prefetch;
+    std::vector<PageState> m_page_state;
+    // Tasks enqueued which haven't finished yet.
+    size_t m_num_tasks {};
+    std::condition_variable m_tasks_done;
+    std::atomic<uint64_t> m_num_misses {0};
+    std::atomic<uint64_t> m_num_late_loads {0};
+};
+
+#endif // EDYN_TESTBED_MAPPED_PAGE_LOADER_HPP
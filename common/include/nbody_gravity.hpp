@@ -0,0 +1,34 @@
+#ifndef EDYN_TESTBED_NBODY_GRAVITY_HPP
+#define EDYN_TESTBED_NBODY_GRAVITY_HPP
+
+#include <edyn/math/scalar.hpp>
+#include <edyn/math/constants.hpp>
+#include <entt/entity/fwd.hpp>
+
+// Mutual gravity between all dynamic rigid bodies, for systems too large to
+// connect every pair with a `gravity_constraint`. Assign it to a single
+// entity, usually one of the bodies, to enable it. It must be registered as
+// an external component so it reaches the simulation worker in asynchronous
+// execution.
+struct NBodyGravity {
+    // Opening angle of the Barnes-Hut approximation. A group of bodies is
+    // treated as a single body at their center of mass if the size of the
+    // group divided by the distance to it is below this. Zero gives the
+    // exact result at quadratic cost, larger values are faster but less
+    // accurate. Values between 0.3 and 0.8 are usual.
+    edyn::scalar theta {0.5};
+    edyn::scalar gravitational_constant {edyn::gravitational_constant};
+    // Smooths out the force at short distances, which would otherwise grow
+    // without bounds when bodies get close since they don't collide.
+    edyn::scalar softening {0.05};
+};
+
+// Builds an octree with the positions and masses of all dynamic rigid bodies
+// and applies the gravitational pull of all other bodies to each, as a change
+// in linear velocity over one fixed step. The tree is rebuilt on every call
+// and bodies are split among the workers of the configured task scheduler.
+// Does nothing if there's no `NBodyGravity`. Meant to be called in the
+// pre-step callback.
+void ApplyNBodyGravity(entt::registry &);
+
+#endif // EDYN_TESTBED_NBODY_GRAVITY_HPP
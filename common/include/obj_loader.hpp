@@ -0,0 +1,24 @@
+#ifndef EDYN_TESTBED_OBJ_LOADER_HPP
+#define EDYN_TESTBED_OBJ_LOADER_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <edyn/context/task.hpp>
+#include <edyn/math/vector3.hpp>
+
+// Loads vertex positions and faces of an OBJ file as a triangle mesh, like
+// `edyn::load_tri_mesh_from_obj`, for files too large to parse in one go.
+// The file is memory mapped and split into chunks at line boundaries which
+// are parsed in parallel using `enqueue_task_wait`, then the results are
+// concatenated in place. Polygons are triangulated as a fan and relative
+// (negative) indices are supported. Everything other than `v` and `f` lines
+// is ignored. Parses on the calling thread if `enqueue_task_wait` is null.
+// Returns false if the file can't be opened or a face refers to a vertex
+// that does not exist.
+bool LoadTriMeshFromObj(const std::string &path,
+                        std::vector<edyn::vector3> &vertices,
+                        std::vector<uint32_t> &indices,
+                        edyn::enqueue_task_wait_t *enqueue_task_wait = nullptr);
+
+#endif // EDYN_TESTBED_OBJ_LOADER_HPP
@@ -0,0 +1,65 @@
+#ifndef EDYN_TESTBED_PAGE_CACHE_HPP
+#define EDYN_TESTBED_PAGE_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <entt/entity/fwd.hpp>
+
+namespace edyn {
+    class triangle_mesh;
+}
+
+class MappedPageLoader;
+
+struct PageCacheSettings {
+    size_t budget_bytes {8 << 20};
+    // A page loaded again within this many seconds of being evicted counts as
+    // a thrash reload.
+    double thrash_window {2};
+    // The cache is considered to be thrashing if more than this fraction of
+    // loads are thrash reloads.
+    double thrash_ratio {0.25};
+};
+
+struct PageCacheStats {
+    size_t resident_bytes {};
+    size_t resident_pages {};
+    uint64_t loads {};
+    uint64_t evictions {};
+    uint64_t thrash_reloads {};
+    // Smoothed rates in pages per second.
+    double load_rate {};
+    double eviction_rate {};
+    double thrash_rate {};
+    bool thrashing {false};
+};
+
+// Heap memory used by a triangle mesh including all per-vertex, per-edge and
+// per-triangle arrays and its tree.
+size_t GetTriangleMeshMemoryUsage(const edyn::triangle_mesh &);
+
+// Takes over cache management of the paged mesh assigned to `mesh_entity`,
+// which must load its pages through `loader`. The vertex count limit of the
+// paged mesh is set from a byte budget according to the actual memory usage
+// of its pages. The paged mesh keeps evicting its least recently used page
+// once over the limit.
+void EnablePageCache(entt::registry &, entt::entity mesh_entity,
+                     std::shared_ptr<MappedPageLoader> loader,
+                     const PageCacheSettings &settings = {});
+void DisablePageCache(entt::registry &);
+PageCacheSettings &GetPageCacheSettings(entt::registry &);
+
+// Accounts pages loaded and evicted since the last update and adjusts the
+// vertex limit of the paged mesh to the measured bytes per vertex. Pages in
+// use by bodies are the most recently used, thus they're evicted last.
+// Meant to be called once per frame.
+void UpdatePageCache(entt::registry &);
+
+const PageCacheStats &GetPageCacheStats(entt::registry &);
+
+// Bytes that can still be loaded without going over budget. Unlimited if the
+// page cache is not enabled.
+size_t GetPageCacheHeadroom(entt::registry &);
+
+#endif // EDYN_TESTBED_PAGE_CACHE_HPP
@@ -0,0 +1,40 @@
+#ifndef EDYN_TESTBED_PAGE_CODEC_HPP
+#define EDYN_TESTBED_PAGE_CODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace edyn {
+    class triangle_mesh;
+}
+
+enum class PageCodec : uint32_t {
+    // Serialized `edyn::triangle_mesh`, including all derived data such as
+    // edges, normals and the triangle tree.
+    Raw,
+    // Same data as `Raw`, thus the edge normals and convexity calculated
+    // against the full mesh by `create_paged_triangle_mesh` are kept and
+    // nothing has to be rebuilt when decoding. Scalars are truncated to
+    // fewer mantissa bits and coded as varints of their difference to the
+    // previous vector component, integers are delta and varint coded and
+    // booleans are packed into bits.
+    Quantized
+};
+
+struct PageCodecSettings {
+    // Mantissa bits kept in scalars, which bounds the relative error of each
+    // value. Vertices shared by neighbouring pages have the exact same value
+    // in both, thus they are truncated the same way and no seams appear.
+    unsigned mantissa_bits {16};
+};
+
+// Appends the encoded mesh to `output`.
+void EncodePage(edyn::triangle_mesh &trimesh, const PageCodecSettings &settings,
+                std::vector<uint8_t> &output);
+
+// Restores a mesh encoded with `EncodePage`. Returns false if the data is
+// malformed, in which case the mesh is left in an unspecified state.
+bool DecodePage(const uint8_t *data, size_t size, edyn::triangle_mesh &trimesh);
+
+#endif // EDYN_TESTBED_PAGE_CODEC_HPP
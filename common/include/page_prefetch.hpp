@@ -0,0 +1,52 @@
+#ifndef EDYN_TESTBED_PAGE_PREFETCH_HPP
+#define EDYN_TESTBED_PAGE_PREFETCH_HPP
+
+#include <cstdint>
+#include <memory>
+#include <edyn/math/scalar.hpp>
+#include <entt/entity/fwd.hpp>
+
+class MappedPageLoader;
+
+struct PagePrefetchSettings {
+    // How far ahead in time to look, in seconds. The AABB of each dynamic body
+    // is swept along its linear velocity over this interval.
+    edyn::scalar horizon {1};
+    // Bodies slower than this are ignored since the paged mesh will load the
+    // pages they reach on demand in time.
+    edyn::scalar min_speed {0.5};
+    // Limits how many pages are requested per update so prefetching doesn't
+    // flood the loader or evict pages that are in use from the cache.
+    unsigned max_loads_per_update {4};
+};
+
+struct PagePrefetchStats {
+    // Pages requested ahead of time.
+    uint64_t prefetches {};
+    // Prefetched pages that were in the cache by the time a body reached them.
+    uint64_t hits {};
+    // Pages the paged mesh had to load on demand without a prediction.
+    uint64_t misses {};
+    // Pages the paged mesh needed while their prefetch was still in flight.
+    uint64_t late_loads {};
+};
+
+// Starts predicting which pages of the paged mesh assigned to `mesh_entity`
+// will be needed soon and loads them ahead of time through `loader`, which
+// must be the loader of that paged mesh.
+void EnablePagePrefetch(entt::registry &, entt::entity mesh_entity,
+                        std::shared_ptr<MappedPageLoader> loader,
+                        const PagePrefetchSettings &settings = {});
+void DisablePagePrefetch(entt::registry &);
+PagePrefetchSettings &GetPagePrefetchSettings(entt::registry &);
+
+// Sweeps the AABB of every dynamic body along its linear velocity and
+// requests the pages it reaches within the horizon, soonest time of contact
+// first. Meant to be called once per frame.
+void UpdatePagePrefetch(entt::registry &);
+
+// Counters since prefetching was enabled. Complements
+// `edyn::on_paged_mesh_page_loaded`.
+PagePrefetchStats GetPagePrefetchStats(entt::registry &);
+
+#endif // EDYN_TESTBED_PAGE_PREFETCH_HPP
@@ -0,0 +1,133 @@
+#ifndef EDYN_TESTBED_RAY_PACKET_HPP
+#define EDYN_TESTBED_RAY_PACKET_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <edyn/comp/aabb.hpp>
+#include <edyn/math/vector3.hpp>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define EDYN_TESTBED_RAY_PACKET_SSE
+#include <xmmintrin.h>
+#endif
+
+// Four ray segments in structure-of-arrays layout for testing against an AABB
+// at once. Segments are parameterized in [0, 1] from `p0` to `p1`.
+struct alignas(16) RayPacket4 {
+    static constexpr unsigned size = 4;
+
+    float origin_x[size], origin_y[size], origin_z[size];
+    float inv_dir_x[size], inv_dir_y[size], inv_dir_z[size];
+    // Bit set for lanes holding an actual ray.
+    unsigned active_mask {};
+
+    // Directions closer than this are avoided when inverting so the slab
+    // test never multiplies zero by infinity.
+    static constexpr float min_dir = 1e-12f;
+
+    static float safeInverse(edyn::scalar d) {
+        auto f = static_cast<float>(d);
+        return 1.f / (std::abs(f) < min_dir ? std::copysign(min_dir, f) : f);
+    }
+
+    void set(unsigned lane, const edyn::vector3 &p0, const edyn::vector3 &p1) {
+        auto dir = p1 - p0;
+        origin_x[lane] = static_cast<float>(p0.x);
+        origin_y[lane] = static_cast<float>(p0.y);
+        origin_z[lane] = static_cast<float>(p0.z);
+        inv_dir_x[lane] = safeInverse(dir.x);
+        inv_dir_y[lane] = safeInverse(dir.y);
+        inv_dir_z[lane] = safeInverse(dir.z);
+        active_mask |= 1u << lane;
+    }
+
+    // Fill unused lanes with a copy of the first ray so they're harmless.
+    void fill() {
+        for (unsigned i = 1; i < size; ++i) {
+            if ((active_mask & (1u << i)) == 0) {
+                origin_x[i] = origin_x[0]; origin_y[i] = origin_y[0]; origin_z[i] = origin_z[0];
+                inv_dir_x[i] = inv_dir_x[0]; inv_dir_y[i] = inv_dir_y[0]; inv_dir_z[i] = inv_dir_z[0];
+            }
+        }
+    }
+};
+
+// Slab test of a single segment against an AABB.
+inline bool IntersectRaySegment(const edyn::vector3 &p0, const edyn::vector3 &p1, const edyn::AABB &aabb) {
+    auto dir = p1 - p0;
+    edyn::scalar t_min = 0, t_max = 1;
+
+    for (int i = 0; i < 3; ++i) {
+        if (std::abs(dir[i]) < EDYN_EPSILON) {
+            if (p0[i] < aabb.min[i] || p0[i] > aabb.max[i]) {
+                return false;
+            }
+            continue;
+        }
+
+        auto inv = edyn::scalar(1) / dir[i];
+        auto t0 = (aabb.min[i] - p0[i]) * inv;
+        auto t1 = (aabb.max[i] - p0[i]) * inv;
+        t_min = std::max(t_min, std::min(t0, t1));
+        t_max = std::min(t_max, std::max(t0, t1));
+
+        if (t_min > t_max) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Slab test of all rays in the packet against an AABB. Returns a mask with
+// the bits of the intersecting lanes set. The box is inflated by a small
+// margin to make up for the reduced precision.
+inline unsigned IntersectRayPacket(const RayPacket4 &packet, const edyn::AABB &aabb) {
+    constexpr float margin = 1e-4f;
+
+#ifdef EDYN_TESTBED_RAY_PACKET_SSE
+    auto slab = [](__m128 origin, __m128 inv_dir, float min, float max, __m128 &t_min, __m128 &t_max) {
+        auto t0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(min), origin), inv_dir);
+        auto t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(max), origin), inv_dir);
+        t_min = _mm_max_ps(t_min, _mm_min_ps(t0, t1));
+        t_max = _mm_min_ps(t_max, _mm_max_ps(t0, t1));
+    };
+
+    auto t_min = _mm_setzero_ps();
+    auto t_max = _mm_set1_ps(1.f);
+
+    slab(_mm_load_ps(packet.origin_x), _mm_load_ps(packet.inv_dir_x),
+         float(aabb.min.x) - margin, float(aabb.max.x) + margin, t_min, t_max);
+    slab(_mm_load_ps(packet.origin_y), _mm_load_ps(packet.inv_dir_y),
+         float(aabb.min.y) - margin, float(aabb.max.y) + margin, t_min, t_max);
+    slab(_mm_load_ps(packet.origin_z), _mm_load_ps(packet.inv_dir_z),
+         float(aabb.min.z) - margin, float(aabb.max.z) + margin, t_min, t_max);
+
+    auto mask = static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(t_min, t_max)));
+    return mask & packet.active_mask;
+#else
+    unsigned mask = 0;
+
+    for (unsigned i = 0; i < RayPacket4::size; ++i) {
+        float t_min = 0, t_max = 1;
+        const float origin[] = {packet.origin_x[i], packet.origin_y[i], packet.origin_z[i]};
+        const float inv_dir[] = {packet.inv_dir_x[i], packet.inv_dir_y[i], packet.inv_dir_z[i]};
+
+        for (int j = 0; j < 3; ++j) {
+            auto t0 = (float(aabb.min[j]) - margin - origin[j]) * inv_dir[j];
+            auto t1 = (float(aabb.max[j]) + margin - origin[j]) * inv_dir[j];
+            t_min = std::max(t_min, std::min(t0, t1));
+            t_max = std::min(t_max, std::max(t0, t1));
+        }
+
+        if (t_min <= t_max) {
+            mask |= 1u << i;
+        }
+    }
+
+    return mask & packet.active_mask;
+#endif
+}
+
+#endif // EDYN_TESTBED_RAY_PACKET_HPP
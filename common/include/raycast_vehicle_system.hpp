@@ -0,0 +1,91 @@
+#ifndef EDYN_TESTBED_RAYCAST_VEHICLE_SYSTEM_HPP
+#define EDYN_TESTBED_RAYCAST_VEHICLE_SYSTEM_HPP
+
+#include <array>
+#include <map>
+#include <vector>
+#include <edyn/math/math.hpp>
+#include <edyn/math/scalar.hpp>
+#include <edyn/math/vector3.hpp>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+
+// Lightweight vehicle made of a single rigid body. Suspension and tyre forces
+// are calculated from one raycast per wheel and applied as impulses on the
+// chassis. The vehicle entity has the same `VehicleSettings`, `VehicleState`
+// and `VehicleActionList` as the multi-body `Vehicle`, thus it is driven by
+// the same actions.
+struct RaycastVehicle {
+    entt::entity chassis_entity {entt::null};
+    // Distance from the mount point to the wheel center along the suspension.
+    std::array<edyn::scalar, 4> suspension_length {};
+    // Wheel angular velocity around its axle and accumulated angle.
+    std::array<edyn::scalar, 4> spin_speed {};
+    std::array<edyn::scalar, 4> spin_angle {};
+    std::array<bool, 4> grounded {};
+};
+
+struct RaycastVehicleSettings {
+    // Top of the suspension of each wheel in chassis space. Same layout as
+    // the multi-body vehicle: front-left, front-right, rear-left, rear-right.
+    std::array<edyn::vector3, 4> mount_position {
+        edyn::vector3{ 0.9, 0,  1.45},
+        edyn::vector3{-0.9, 0,  1.45},
+        edyn::vector3{ 0.9, 0, -1.45},
+        edyn::vector3{-0.9, 0, -1.45}
+    };
+    edyn::scalar wheel_radius {0.4};
+    edyn::scalar wheel_inertia {4};
+    edyn::scalar rest_length {0.5};
+    edyn::scalar max_length {0.8};
+    edyn::scalar spring_stiffness {40000};
+    edyn::scalar damping {1100};
+    edyn::scalar bump_stop_length {0.1};
+    edyn::scalar bump_stop_stiffness {180000};
+    edyn::scalar tyre_friction {1};
+};
+
+template<typename Archive>
+void serialize(Archive &archive, RaycastVehicle &vehicle) {
+    archive(vehicle.chassis_entity);
+    archive(vehicle.suspension_length);
+    archive(vehicle.spin_speed);
+    archive(vehicle.spin_angle);
+    archive(vehicle.grounded);
+}
+
+template<typename Archive>
+void serialize(Archive &archive, RaycastVehicleSettings &settings) {
+    archive(settings.mount_position);
+    archive(settings.wheel_radius);
+    archive(settings.wheel_inertia);
+    archive(settings.rest_length);
+    archive(settings.max_length);
+    archive(settings.spring_stiffness);
+    archive(settings.damping);
+    archive(settings.bump_stop_length);
+    archive(settings.bump_stop_stiffness);
+    archive(settings.tyre_friction);
+}
+
+enum class RaycastVehicleAssetEntry : unsigned short {
+    Vehicle
+};
+static constexpr auto RaycastVehicleAssetID = "RaycastVehicleAsset";
+
+// Creates a raycast vehicle where the vehicle entity is also the chassis.
+entt::entity CreateRaycastVehicle(entt::registry &, edyn::vector3 position = {0, 2, 0});
+// Turns an existing entity holding the vehicle components into a raycast
+// vehicle driving the given chassis.
+void MakeRaycastVehicle(entt::registry &, entt::entity vehicle_entity, entt::entity chassis_entity);
+entt::entity MakeRaycastVehicleNetworked(entt::registry &, entt::entity vehicle_entity);
+// Applies suspension and tyre impulses. Vehicle actions must have been
+// processed beforehand by calling `ProcessVehicleActions` or one of the
+// multi-body vehicle updates, which process actions of all vehicles.
+void UpdateRaycastVehicles(entt::registry &);
+std::vector<entt::entity> GetRaycastVehicleEntities(entt::registry &, entt::entity);
+
+std::map<entt::id_type, entt::entity>
+CreateRaycastVehicleAssetEntityMap(entt::registry &registry, entt::entity vehicleEntity);
+
+#endif // EDYN_TESTBED_RAYCAST_VEHICLE_SYSTEM_HPP
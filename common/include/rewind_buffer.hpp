@@ -0,0 +1,88 @@
+#ifndef EDYN_TESTBED_REWIND_BUFFER_HPP
+#define EDYN_TESTBED_REWIND_BUFFER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <edyn/math/scalar.hpp>
+#include <edyn/math/vector3.hpp>
+#include <entt/entity/entity.hpp>
+#include <entt/entity/fwd.hpp>
+
+// Keeps the state of all rigid bodies over the last few seconds so the
+// simulation can be stepped back and forth to inspect what led to an
+// instability, and the window can be saved to a replay file.
+//
+// Each frame holds transforms, velocities and contacts quantized to a fixed
+// step and delta encoded against the previous frame, with a full keyframe
+// every so often. A body at rest costs a single byte per frame. A resting
+// contact costs one byte plus the change in its impulse, as long as the set
+// of contacts doesn't change. Frame buffers are recycled once out of the
+// window, thus memory stays flat after the window fills up.
+
+struct RewindSettings {
+    // Length of the window in seconds of simulation time.
+    double duration {10};
+    // Frames in between keyframes. Seeking decodes from the closest
+    // keyframe before the target frame.
+    unsigned keyframe_interval {60};
+    // Quantization steps. Fixed once rewind is enabled.
+    edyn::scalar position_step {edyn::scalar(1e-4)};
+    edyn::scalar orientation_step {edyn::scalar(1) / 65536};
+    edyn::scalar velocity_step {edyn::scalar(1e-3)};
+    edyn::scalar impulse_step {edyn::scalar(1e-3)};
+    // Record contact points and their impulses along with the bodies.
+    bool record_contacts {true};
+};
+
+struct RewindStats {
+    size_t num_frames {};
+    // Bytes used by the frames in the window and by the recycled frames.
+    size_t used_bytes {};
+    size_t pooled_bytes {};
+    double window_duration {};
+};
+
+// A contact point as recorded, for inspection only since contacts can't be
+// put back into the simulation.
+struct RewindContact {
+    std::array<entt::entity, 2> body;
+    edyn::vector3 point;
+    edyn::vector3 normal;
+    // Normal impulse applied in the step, which is also what the solver
+    // warm starts from in the next step.
+    edyn::scalar normal_impulse;
+};
+
+void EnableRewind(entt::registry &, const RewindSettings &settings = {});
+void DisableRewind(entt::registry &);
+RewindSettings &GetRewindSettings(entt::registry &);
+
+// Appends the current state of all rigid bodies. If rewound, the frames
+// after the current one are discarded first, thus the simulation branches
+// off from there. Meant to be called once per simulation step, after its
+// state has reached the registry.
+void RecordRewindFrame(entt::registry &);
+
+// Discards all frames, such as when the world is reset and the recorded
+// frames don't lead to its current state anymore.
+void ClearRewind(entt::registry &);
+
+// Moves by `offset` frames and assigns the state of that frame to all
+// bodies that still exist. Returns false if there's no frame there.
+bool SeekRewind(entt::registry &, int offset);
+
+// Whether the current frame is not the latest.
+bool IsRewound(entt::registry &);
+
+// Contacts of the current frame. Empty unless rewound.
+const std::vector<RewindContact> &GetRewindContacts(entt::registry &);
+
+// Writes all frames in the window into a file, as encoded in memory.
+bool ExportRewindReplay(entt::registry &, const std::string &path);
+
+RewindStats GetRewindStats(entt::registry &);
+
+#endif // EDYN_TESTBED_REWIND_BUFFER_HPP
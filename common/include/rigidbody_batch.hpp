@@ -0,0 +1,24 @@
+#ifndef EDYN_TESTBED_RIGIDBODY_BATCH_HPP
+#define EDYN_TESTBED_RIGIDBODY_BATCH_HPP
+
+#include <cstddef>
+#include <vector>
+#include <edyn/math/vector3.hpp>
+#include <edyn/util/rigidbody.hpp>
+#include <entt/entity/fwd.hpp>
+
+// Creates many rigid bodies at once, which is cheaper than calling
+// `edyn::make_rigidbody` in a loop. Entities are created in bulk and the
+// storage of the components every rigid body gets is reserved up front, so
+// pools grow once instead of reallocating as bodies are added. The moment
+// of inertia of dynamic bodies without one is computed once per distinct
+// shape and mass (see `GetShapeInertia`). Returns the new entities in the
+// order of the definitions.
+std::vector<entt::entity> MakeRigidBodies(entt::registry &, const edyn::rigidbody_def *defs, size_t count);
+
+// Creates one rigid body per position, all sharing the same definition
+// otherwise. Meant for spawning debris and stacks.
+std::vector<entt::entity> MakeRigidBodies(entt::registry &, const edyn::rigidbody_def &def,
+                                          const edyn::vector3 *positions, size_t count);
+
+#endif // EDYN_TESTBED_RIGIDBODY_BATCH_HPP
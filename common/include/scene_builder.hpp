@@ -0,0 +1,95 @@
+#ifndef EDYN_TESTBED_SCENE_BUILDER_HPP
+#define EDYN_TESTBED_SCENE_BUILDER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <entt/entity/fwd.hpp>
+
+// Builds a scene over several frames instead of all at once, so the window
+// keeps rendering while assets load. A scene is described as a sequence of
+// stages which are run in order by calling `update` once per frame:
+//  - Loads run in background tasks of the Edyn scheduler. Consecutive loads
+//    run concurrently. They must not touch the registry and are meant for
+//    reading files and preprocessing shapes.
+//  - Builds run on the main thread once all stages before them are done,
+//    e.g. to create the bodies using the results of the preceding loads.
+//  - Batches call a function once per index on the main thread, as many
+//    times per frame as fit in the time budget given to `update`.
+// Stages are usually captured by value in the functions, and the results of
+// loads are passed on to later stages through shared pointers.
+class SceneBuilder {
+public:
+    using load_func_t = std::function<void()>;
+    using build_func_t = std::function<void(entt::registry &)>;
+    using batch_func_t = std::function<void(entt::registry &, size_t index)>;
+
+    SceneBuilder() = default;
+    SceneBuilder(const SceneBuilder &) = delete;
+    SceneBuilder &operator=(const SceneBuilder &) = delete;
+    ~SceneBuilder() { cancel(); }
+
+    void load(std::string label, load_func_t func);
+    void build(std::string label, build_func_t func);
+    void buildBatched(std::string label, size_t count, batch_func_t func);
+
+    // Marks the point after which the static world is complete and the
+    // simulation can start running while the remaining stages are built.
+    // If never called, that happens once everything is built.
+    void staticWorldReady();
+
+    // Runs stages until the time budget in seconds is exhausted or a load
+    // that's still running is reached. The budget is not a hard limit since
+    // a single build can't be interrupted.
+    void update(entt::registry &registry, double time_budget);
+
+    // Waits for running loads to finish and discards the remaining stages.
+    void cancel();
+
+    bool isBuilding() const { return !m_stages.empty(); }
+    bool isStaticWorldReady() const { return m_static_world_ready; }
+
+    // Fraction of stages completed in [0, 1], including the fraction of the
+    // current batch.
+    float progress() const;
+    // Label of the stage currently being run.
+    const std::string &currentLabel() const;
+
+private:
+    enum class StageKind {
+        Load,
+        Build,
+        Batch,
+        StaticWorldReady
+    };
+
+    struct LoadTask {
+        load_func_t func;
+        std::atomic<bool> done {false};
+
+        void run(unsigned start, unsigned end);
+    };
+
+    struct Stage {
+        StageKind kind;
+        std::string label;
+        build_func_t build;
+        batch_func_t batch;
+        size_t count {};
+        size_t next {};
+        // Allocated separately since its address must stay valid while the
+        // task runs.
+        std::unique_ptr<LoadTask> task;
+        bool launched {false};
+    };
+
+    std::deque<Stage> m_stages;
+    size_t m_num_stages {};
+    size_t m_num_completed {};
+    bool m_static_world_ready {true};
+};
+
+#endif // EDYN_TESTBED_SCENE_BUILDER_HPP
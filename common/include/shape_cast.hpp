@@ -0,0 +1,65 @@
+#ifndef EDYN_TESTBED_SHAPE_CAST_HPP
+#define EDYN_TESTBED_SHAPE_CAST_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <edyn/math/vector3.hpp>
+#include <edyn/math/quaternion.hpp>
+#include <edyn/collision/raycast.hpp>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+#include <entt/signal/delegate.hpp>
+
+enum class ShapeCastKind {
+    Sphere,
+    Box
+};
+
+// A sphere or box swept from `p0` to `p1` without rotation.
+struct ShapeCast {
+    ShapeCastKind kind {ShapeCastKind::Sphere};
+    edyn::vector3 p0 {edyn::vector3_zero};
+    edyn::vector3 p1 {edyn::vector3_zero};
+    // Sphere radius.
+    edyn::scalar radius {};
+    // Box half extents and orientation.
+    edyn::vector3 half_extents {edyn::vector3_zero};
+    edyn::quaternion orientation {edyn::quaternion_identity};
+    std::array<entt::entity, 2> ignore {entt::null, entt::null};
+    // Entity casting this shape and index of the cast among its casts. Not
+    // used by the query, only passed back to the delegate in async casts.
+    entt::entity owner {entt::null};
+    uint32_t owner_index {};
+};
+
+// Sweeps the shape against the world and returns the first hit, in the same
+// format as a raycast. The fraction is where along the sweep the shape first
+// touches another shape and the normal points from the other shape towards
+// the swept shape. Feature info is set for meshes, paged meshes and compound
+// shapes. If the shape starts in contact, the fraction is zero. Hits are
+// found by conservative advancement thus they're accurate to about a
+// millimeter.
+edyn::raycast_result ShapeCastQuery(entt::registry &, const ShapeCast &);
+
+// Up to two entities can be ignored, as in `ShapeCast::ignore`. Unused
+// entries must be `entt::null`.
+edyn::raycast_result SphereCast(entt::registry &, edyn::vector3 p0, edyn::vector3 p1, edyn::scalar radius,
+                                std::array<entt::entity, 2> ignore = {entt::null, entt::null});
+edyn::raycast_result BoxCast(entt::registry &, edyn::vector3 p0, edyn::vector3 p1,
+                             edyn::vector3 half_extents, edyn::quaternion orientation,
+                             std::array<entt::entity, 2> ignore = {entt::null, entt::null});
+
+using ShapeCastDelegate = entt::delegate<void(const ShapeCast &, const edyn::raycast_result &)>;
+
+// Queues a shape cast which is executed in the next call to
+// `FlushShapeCasts`, where the delegate is invoked with the result.
+void ShapeCastAsync(entt::registry &, const ShapeCast &, ShapeCastDelegate);
+
+// Executes all queued shape casts, split among the workers of the configured
+// task scheduler when there are enough of them, and then invokes their
+// delegates on the calling thread in the order they were queued. Meant to be
+// called in the pre-step callback.
+void FlushShapeCasts(entt::registry &);
+
+#endif // EDYN_TESTBED_SHAPE_CAST_HPP
@@ -0,0 +1,29 @@
+#ifndef EDYN_TESTBED_SHAPE_SWAP_HPP
+#define EDYN_TESTBED_SHAPE_SWAP_HPP
+
+#include <cstddef>
+#include <edyn/math/scalar.hpp>
+#include <edyn/math/matrix3x3.hpp>
+#include <edyn/shapes/shapes.hpp>
+#include <entt/entity/fwd.hpp>
+
+// Moment of inertia of a shape with the given mass, computed once and then
+// looked up in a cache kept in the registry context. Shapes are matched by
+// their parameters, and polyhedrons by their mesh. Compound shapes are not
+// cached.
+edyn::matrix3x3 GetShapeInertia(entt::registry &, const edyn::shapes_variant_t &shape, edyn::scalar mass);
+
+// Whether two shapes are the same, matched by their parameters, and by their
+// mesh for polyhedrons and triangle meshes. Compound shapes are matched node
+// by node.
+bool IsSameShape(const edyn::shapes_variant_t &a, const edyn::shapes_variant_t &b);
+
+// Assigns the same shape to each rigid body in turn, along with the matching
+// moment of inertia for its current mass. Every body still goes through
+// `rigidbody_set_shape` and `set_rigidbody_inertia`; the only saving is the
+// inertia, which is looked up in a cache shared across calls, so repeated
+// swaps between the same shapes do not recompute it.
+void SetRigidBodiesShape(entt::registry &, const entt::entity *entities, size_t count,
+                         const edyn::shapes_variant_t &shape);
+
+#endif // EDYN_TESTBED_SHAPE_SWAP_HPP
@@ -0,0 +1,68 @@
+#ifndef EDYN_TESTBED_TRIGGER_VOLUME_HPP
+#define EDYN_TESTBED_TRIGGER_VOLUME_HPP
+
+#include <cstddef>
+#include <edyn/comp/aabb.hpp>
+#include <edyn/math/vector3.hpp>
+#include <edyn/math/quaternion.hpp>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+#include <entt/signal/delegate.hpp>
+
+enum class TriggerShape {
+    Box,
+    Sphere
+};
+
+// Volume which reports the rigid bodies overlapping it. Unlike sensors, it is
+// not a rigid body thus it never creates contact manifolds nor goes through
+// the narrowphase. Overlaps are found between the AABB of the volume and the
+// AABB of all non-static bodies. Changes to it must be notified with a patch.
+struct TriggerVolume {
+    TriggerShape shape {TriggerShape::Box};
+    edyn::vector3 half_extents {edyn::vector3_one};
+    edyn::scalar radius {1};
+    edyn::vector3 position {edyn::vector3_zero};
+    edyn::quaternion orientation {edyn::quaternion_identity};
+    // Also test the actual shape of the volume against the AABB of the
+    // bodies. It's exact for the volume and conservative for the bodies.
+    bool exact {true};
+};
+
+enum class TriggerEventType {
+    Enter,
+    Exit
+};
+
+struct TriggerEvent {
+    TriggerEventType type;
+    // The trigger or the body might not be valid anymore in exit events if
+    // they were destroyed.
+    entt::entity trigger;
+    entt::entity body;
+};
+
+// Receives all events of an update at once, grouped by trigger.
+using TriggerEventDelegate = entt::delegate<void(const TriggerEvent *, size_t)>;
+
+// Bodies currently overlapping a trigger, sorted by entity. Valid until the
+// next update.
+struct TriggerOverlaps {
+    const entt::entity *bodies {nullptr};
+    size_t count {};
+};
+
+entt::entity CreateTriggerVolume(entt::registry &, const TriggerVolume &);
+
+edyn::AABB GetTriggerVolumeAABB(const TriggerVolume &);
+
+// Finds all overlaps between trigger volumes and bodies and invokes the
+// delegate with the bodies that entered or exited each trigger since the
+// last update, if any. Bodies and triggers are sorted along one axis and
+// swept, thus there's no need for the volumes to be in the broadphase tree.
+// Must be called on the main registry, usually after updating physics.
+void UpdateTriggerVolumes(entt::registry &, TriggerEventDelegate delegate = {});
+
+TriggerOverlaps GetTriggerOverlaps(entt::registry &, entt::entity trigger);
+
+#endif // EDYN_TESTBED_TRIGGER_VOLUME_HPP
@@ -0,0 +1,51 @@
+#ifndef EDYN_TESTBED_VEHICLE_LOD_HPP
+#define EDYN_TESTBED_VEHICLE_LOD_HPP
+
+#include <vector>
+#include <edyn/comp/aabb.hpp>
+#include <edyn/math/scalar.hpp>
+#include <entt/entity/fwd.hpp>
+#include <entt/entity/entity.hpp>
+
+enum class VehicleLODLevel {
+    Full,       // Multi-body `Vehicle`.
+    Simplified  // Single-body `RaycastVehicle`.
+};
+
+// Assigned to vehicles managed by `UpdateVehicleLOD`. Only lives in the main
+// registry. The vehicle entity, chassis and null constraint are kept in both
+// representations, only the wheels and suspension are created or destroyed.
+struct VehicleLOD {
+    VehicleLODLevel level {VehicleLODLevel::Full};
+    double last_change_time {};
+    entt::entity null_con_entity {entt::null};
+};
+
+struct VehicleLODSettings {
+    // Vehicles closer than this to a region of interest use the full model.
+    edyn::scalar full_distance {40};
+    // Vehicles farther than this from all regions of interest use the
+    // simplified model. The gap between both distances prevents vehicles
+    // at the boundary from switching back and forth.
+    edyn::scalar simplified_distance {60};
+    // Minimum time in seconds a vehicle stays in one representation.
+    double min_dwell_time {2};
+    // Maximum number of vehicles migrated per update, to spread the cost of
+    // creating and destroying wheels over multiple frames. Vehicles getting
+    // closer are migrated first.
+    unsigned max_migrations_per_update {4};
+};
+
+// Starts managing the level of detail of a vehicle created with
+// `CreateVehicle`. Vehicles that are networked assets must not be managed
+// since their assets reference the wheel entities.
+void MakeVehicleLOD(entt::registry &, entt::entity vehicle_entity);
+
+// Migrates managed vehicles between the full and simplified models based on
+// their distance to the closest region of interest, carrying over chassis
+// pose and velocity, suspension travel and wheel spin. Must be called on the
+// main registry.
+void UpdateVehicleLOD(entt::registry &, const std::vector<edyn::AABB> &regions,
+                      const VehicleLODSettings &settings);
+
+#endif // EDYN_TESTBED_VEHICLE_LOD_HPP
@@ -9,6 +9,9 @@
 #include <variant>
 #include <edyn/math/math.hpp>
 #include <edyn/math/scalar.hpp>
+#include <edyn/math/vector3.hpp>
+#include <edyn/math/quaternion.hpp>
+#include <edyn/math/matrix3x3.hpp>
 #include <entt/entity/fwd.hpp>
 
 struct Vehicle {
@@ -34,6 +37,20 @@ struct VehicleSettings {
     edyn::scalar camber {edyn::to_radians(-6)};
 };
 
+// Initial state of a wheel rigid body.
+struct VehicleWheelState {
+    edyn::vector3 position {edyn::vector3_zero};
+    edyn::quaternion orientation {edyn::quaternion_identity};
+    edyn::vector3 linvel {edyn::vector3_zero};
+    edyn::vector3 angvel {edyn::vector3_zero};
+};
+
+// Outputs of the traction control and ABS of a single wheel.
+struct WheelControl {
+    edyn::vector3 torque_impulse {edyn::vector3_zero};
+    edyn::scalar friction_torque {};
+};
+
 template<typename Archive>
 void serialize(Archive &archive, Vehicle &vehicle) {
     archive(vehicle.chassis_entity);
@@ -126,9 +143,34 @@ static constexpr auto VehicleAssetID = "VehicleAsset";
 
 void RegisterVehicleComponents(entt::registry &);
 void RegisterNetworkedVehicleComponents(entt::registry &);
-entt::entity CreateVehicle(entt::registry &);
+entt::entity CreateVehicle(entt::registry &, edyn::vector3 position = {0, 2, 0});
+// Creates the wheels and suspension constraints of a vehicle whose chassis
+// already exists and assigns them to `vehicle`.
+void CreateVehicleWheels(entt::registry &, Vehicle &, const VehicleSettings &,
+                         const std::array<VehicleWheelState, 4> &);
+void DestroyVehicleWheels(entt::registry &, Vehicle &);
 entt::entity MakeVehicleNetworked(entt::registry &, entt::entity vehicleEntity);
+void ProcessVehicleActions(entt::registry &);
+void AdvanceSteering(const VehicleSettings &, VehicleState &, edyn::scalar dt);
+edyn::scalar GetWheelSteering(const VehicleState &, int wheel_index);
+std::array<edyn::matrix3x3, 2> UpdateSteering(const VehicleSettings &, VehicleState &, edyn::scalar dt);
+void ApplySteering(entt::registry &, const Vehicle &, const VehicleSettings &, VehicleState &, edyn::scalar dt);
+WheelControl ComputeWheelControl(const VehicleSettings &, const VehicleState &,
+                                 const edyn::vector3 &wheel_linvel, const edyn::vector3 &wheel_angvel,
+                                 const edyn::quaternion &wheel_orn, edyn::scalar dt);
 void UpdateVehicles(entt::registry &);
+
+// Same as `UpdateVehicles` but gathers the wheel state of all awake vehicles
+// into packed arrays, computes traction control and ABS for all wheels at
+// once, possibly in parallel using the configured task scheduler, and then
+// writes the results back. Preferable when there are many vehicles.
+void UpdateVehiclesBatched(entt::registry &);
+
+// Same as `UpdateVehicles` but vehicles are partitioned among the workers of
+// the configured task scheduler. Each partition records its constraint and
+// velocity changes into its own command buffer without touching the registry
+// and the buffers are applied afterwards in a short serial phase.
+void UpdateVehiclesParallel(entt::registry &);
 std::vector<entt::entity> GetVehicleEntities(entt::registry &, entt::entity);
 
 std::map<entt::id_type, entt::entity>
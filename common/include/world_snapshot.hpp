@@ -0,0 +1,56 @@
+#ifndef EDYN_TESTBED_WORLD_SNAPSHOT_HPP
+#define EDYN_TESTBED_WORLD_SNAPSHOT_HPP
+
+#include <cstdint>
+#include <vector>
+#include <edyn/comp/material.hpp>
+#include <edyn/math/matrix3x3.hpp>
+#include <edyn/math/quaternion.hpp>
+#include <edyn/math/vector3.hpp>
+#include <edyn/shapes/shapes.hpp>
+#include <edyn/util/rigidbody.hpp>
+#include <entt/entity/entity.hpp>
+#include <entt/entity/fwd.hpp>
+
+// State of one rigid body. Trivially copyable, so a snapshot is a flat
+// array of these plus the shapes.
+struct WorldSnapshotBody {
+    entt::entity entity;
+    edyn::rigidbody_kind kind;
+    // Index into `WorldSnapshot::shapes`, or -1 for bodies without a shape.
+    int32_t shape;
+    bool has_material;
+    bool networked;
+    bool presentation;
+    edyn::material material;
+    edyn::scalar mass;
+    edyn::matrix3x3 inertia;
+    edyn::vector3 position;
+    edyn::quaternion orientation;
+    edyn::vector3 linvel;
+    edyn::vector3 angvel;
+};
+
+// In-memory copy of all rigid bodies in a registry, which can be restored
+// to bring the world back to that exact state without tearing down the
+// registry, Edyn or the assets. Meshes and polyhedrons are held by
+// reference, thus taking a snapshot doesn't copy them. Constraints, anything
+// other than rigid bodies and bodies owned by network clients (i.e. with an
+// `edyn::entity_owner`) are not part of it.
+struct WorldSnapshot {
+    std::vector<WorldSnapshotBody> bodies;
+    std::vector<edyn::shapes_variant_t> shapes;
+
+    bool empty() const { return bodies.empty(); }
+};
+
+WorldSnapshot TakeWorldSnapshot(entt::registry &);
+
+// Restores all bodies in one pass. Bodies that still exist are moved back
+// and have their velocities, kind, shape, mass, inertia and material reset.
+// Bodies destroyed since the snapshot was taken are created again, under the
+// same entity if that identifier is still free, and bodies created since are
+// destroyed. Bodies owned by clients are left untouched.
+void RestoreWorldSnapshot(entt::registry &, const WorldSnapshot &);
+
+#endif // EDYN_TESTBED_WORLD_SNAPSHOT_HPP
@@ -0,0 +1,245 @@
+#include "async_log.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Single producer, single consumer ring of fixed size messages. The owning
+// thread pushes and the writer thread pops.
+class LogRing {
+public:
+    static constexpr size_t capacity = 1024;
+    static constexpr size_t message_size = 256;
+
+    bool push(const char *message, size_t length) {
+        auto head = m_head.load(std::memory_order_relaxed);
+
+        if (head - m_tail.load(std::memory_order_acquire) == capacity) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        auto &slot = m_slots[head % capacity];
+        slot.length = static_cast<uint16_t>(std::min(length, message_size));
+        std::copy_n(message, slot.length, slot.data);
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename Func>
+    void drain(Func func) {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        auto head = m_head.load(std::memory_order_acquire);
+
+        for (; tail != head; ++tail) {
+            auto &slot = m_slots[tail % capacity];
+            func(slot.data, slot.length);
+        }
+
+        m_tail.store(tail, std::memory_order_release);
+    }
+
+    bool empty() const {
+        return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+    }
+
+    uint64_t takeDropped() {
+        return m_dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        uint16_t length;
+        char data[message_size];
+    };
+
+    // Keep producer and consumer indices in separate cache lines.
+    alignas(64) std::atomic<size_t> m_head {0};
+    alignas(64) std::atomic<size_t> m_tail {0};
+    std::atomic<uint64_t> m_dropped {0};
+    std::array<Slot, capacity> m_slots;
+};
+
+class AsyncLogger {
+public:
+    // How often the writer looks for new messages.
+    static constexpr auto poll_interval = std::chrono::milliseconds(5);
+
+    AsyncLogger()
+        : m_writer(&AsyncLogger::run, this)
+    {}
+
+    ~AsyncLogger() {
+        {
+            std::lock_guard lock(m_mutex);
+            m_running = false;
+        }
+
+        m_cv.notify_one();
+        m_writer.join();
+    }
+
+    std::shared_ptr<LogRing> makeRing() {
+        auto ring = std::make_shared<LogRing>();
+        std::lock_guard lock(m_mutex);
+        m_rings.push_back(ring);
+        return ring;
+    }
+
+    void flush() {
+        std::unique_lock lock(m_mutex);
+        auto target = ++m_flush_requests;
+        m_cv.notify_one();
+        m_flush_cv.wait(lock, [&] { return m_flush_done >= target || !m_running; });
+    }
+
+private:
+    void run() {
+        auto rings = std::vector<std::shared_ptr<LogRing>>{};
+        auto buffer = std::string{};
+        auto running = true;
+
+        while (running) {
+            uint64_t flush_requests;
+
+            {
+                std::unique_lock lock(m_mutex);
+                m_cv.wait_for(lock, poll_interval, [&] {
+                    return !m_running || m_flush_requests > m_flush_done;
+                });
+                running = m_running;
+                flush_requests = m_flush_requests;
+
+                // Forget rings of threads that are gone once they're empty.
+                m_rings.erase(std::remove_if(m_rings.begin(), m_rings.end(), [](auto &ring) {
+                    return ring.use_count() == 1 && ring->empty();
+                }), m_rings.end());
+                rings = m_rings;
+            }
+
+            for (auto &ring : rings) {
+                ring->drain([&](const char *data, size_t length) {
+                    buffer.append(data, length);
+                    buffer.push_back('\n');
+                });
+
+                if (auto dropped = ring->takeDropped()) {
+                    buffer += "Log buffer full, dropped " + std::to_string(dropped) + " messages.\n";
+                }
+            }
+
+            rings.clear();
+
+            if (!buffer.empty()) {
+                std::fwrite(buffer.data(), 1, buffer.size(), stdout);
+                std::fflush(stdout);
+                buffer.clear();
+            }
+
+            if (flush_requests > 0) {
+                std::lock_guard lock(m_mutex);
+                m_flush_done = flush_requests;
+                m_flush_cv.notify_all();
+            }
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_flush_cv;
+    std::vector<std::shared_ptr<LogRing>> m_rings;
+    uint64_t m_flush_requests {0};
+    uint64_t m_flush_done {0};
+    bool m_running {true};
+    std::thread m_writer;
+};
+
+static AsyncLogger &GetLogger() {
+    static AsyncLogger logger;
+    return logger;
+}
+
+static LogRing &GetThreadRing() {
+    // The logger also holds a reference thus queued messages are still
+    // written after the thread exits.
+    thread_local auto ring = GetLogger().makeRing();
+    return *ring;
+}
+
+static void LogFormatted(const char *suffix, const char *format, va_list args) {
+    char message[LogRing::message_size];
+    auto length = std::vsnprintf(message, sizeof(message), format, args);
+
+    if (length < 0) {
+        return;
+    }
+
+    auto size = std::min(static_cast<size_t>(length), sizeof(message) - 1);
+
+    if (suffix != nullptr) {
+        auto suffix_length = std::snprintf(message + size, sizeof(message) - size, "%s", suffix);
+        size = std::min(size + static_cast<size_t>(std::max(suffix_length, 0)), sizeof(message) - 1);
+    }
+
+    GetThreadRing().push(message, size);
+}
+
+void Log(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    LogFormatted(nullptr, format, args);
+    va_end(args);
+}
+
+void Log(LogRateLimiter &limiter, const char *format, ...) {
+    auto suppressed = limiter.suppressed();
+
+    if (!limiter.allow()) {
+        return;
+    }
+
+    char suffix[48] = {};
+
+    if (suppressed > 0) {
+        std::snprintf(suffix, sizeof(suffix), " (%llu suppressed)", static_cast<unsigned long long>(suppressed));
+    }
+
+    va_list args;
+    va_start(args, format);
+    LogFormatted(suffix, format, args);
+    va_end(args);
+}
+
+void FlushLog() {
+    GetLogger().flush();
+}
+
+LogRateLimiter::LogRateLimiter(double rate, double burst)
+    : m_rate(rate)
+    , m_burst(burst)
+    , m_tokens(burst)
+    , m_last(clock::now())
+{}
+
+bool LogRateLimiter::allow() {
+    auto now = clock::now();
+    auto elapsed = std::chrono::duration<double>(now - m_last).count();
+    m_last = now;
+    m_tokens = std::min(m_tokens + elapsed * m_rate, m_burst);
+
+    if (m_tokens < 1) {
+        ++m_suppressed;
+        return false;
+    }
+
+    m_tokens -= 1;
+    m_suppressed = 0;
+    return true;
+}
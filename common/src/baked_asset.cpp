@@ -0,0 +1,131 @@
+#include "baked_asset.hpp"
+#include "async_log.hpp"
+#include <cstring>
+#include <fstream>
+#include <edyn/serialization/memory_archive.hpp>
+#include <edyn/serialization/paged_triangle_mesh_s11n.hpp>
+#include <edyn/serialization/shape_s11n.hpp>
+
+uint64_t ComputeChecksum(const uint8_t *data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+std::string GetBakedAssetPath(const std::string &name, const std::string &directory) {
+    return directory + name + baked_asset_extension;
+}
+
+bool WriteBakedAsset(const std::string &path, BakedAssetKind kind, const std::vector<uint8_t> &payload) {
+    auto header = BakedAssetHeader{};
+    header.kind = kind;
+    header.payload_size = payload.size();
+    header.checksum = ComputeChecksum(payload.data(), payload.size());
+
+    auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+
+    if (!file) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+    return static_cast<bool>(file);
+}
+
+bool ReadBakedAsset(const std::string &path, BakedAssetKind kind, std::vector<uint8_t> &payload) {
+    auto file = std::ifstream(path, std::ios::binary);
+
+    if (!file) {
+        return false;
+    }
+
+    auto header = BakedAssetHeader{};
+
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, BakedAssetHeader{}.magic, sizeof(header.magic)) != 0 ||
+        header.version != BakedAssetHeader::current_version ||
+        header.kind != kind) {
+        return false;
+    }
+
+    payload.resize(header.payload_size);
+
+    if (!file.read(reinterpret_cast<char *>(payload.data()), payload.size())) {
+        return false;
+    }
+
+    return ComputeChecksum(payload.data(), payload.size()) == header.checksum;
+}
+
+template<typename T>
+static bool SaveBaked(const std::string &path, BakedAssetKind kind, const T &value) {
+    auto payload = std::vector<uint8_t>{};
+    auto archive = edyn::memory_output_archive(payload);
+    // Serialization functions take a non-const reference since they are
+    // used for input and output.
+    edyn::serialize(archive, const_cast<T &>(value));
+    return WriteBakedAsset(path, kind, payload);
+}
+
+template<typename T>
+static bool LoadBaked(const std::string &name, BakedAssetKind kind, T &value) {
+    auto path = GetBakedAssetPath(name);
+    auto payload = std::vector<uint8_t>{};
+
+    if (!ReadBakedAsset(path, kind, payload)) {
+        Log("Missing or invalid baked asset %s. Run EdynTestbedBaker to bake resources.", path.c_str());
+        return false;
+    }
+
+    auto archive = edyn::memory_input_archive(payload.data(), payload.size());
+    edyn::serialize(archive, value);
+    return true;
+}
+
+bool SaveBakedTriangleMesh(const std::string &path, const edyn::triangle_mesh &trimesh) {
+    return SaveBaked(path, BakedAssetKind::TriangleMesh, trimesh);
+}
+
+bool SaveBakedPolyhedron(const std::string &path, const edyn::polyhedron_shape &shape) {
+    return SaveBaked(path, BakedAssetKind::Polyhedron, shape);
+}
+
+bool SaveBakedCompound(const std::string &path, const edyn::compound_shape &shape) {
+    return SaveBaked(path, BakedAssetKind::Compound, shape);
+}
+
+std::shared_ptr<edyn::triangle_mesh> LoadBakedTriangleMesh(const std::string &name) {
+    auto trimesh = std::make_shared<edyn::triangle_mesh>();
+
+    if (!LoadBaked(name, BakedAssetKind::TriangleMesh, *trimesh)) {
+        return {};
+    }
+
+    return trimesh;
+}
+
+std::optional<edyn::polyhedron_shape> LoadBakedPolyhedron(const std::string &name) {
+    auto shape = edyn::polyhedron_shape{};
+
+    if (!LoadBaked(name, BakedAssetKind::Polyhedron, shape)) {
+        return {};
+    }
+
+    return shape;
+}
+
+std::optional<edyn::compound_shape> LoadBakedCompound(const std::string &name) {
+    auto shape = edyn::compound_shape{};
+
+    if (!LoadBaked(name, BakedAssetKind::Compound, shape)) {
+        return {};
+    }
+
+    return shape;
+}
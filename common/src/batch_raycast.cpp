@@ -0,0 +1,508 @@
+#include "batch_raycast.hpp"
+#include "ray_packet.hpp"
+#include "collision_query_world.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include <edyn/context/task.hpp>
+#include <edyn/util/aabb_util.hpp>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+// Last hit of rays with an owner. Only hits on static entities are cached
+// since their features stay in place.
+struct RaycastHitCache {
+    // Number of consecutive steps a cached hit is reused without a
+    // broadphase query.
+    static constexpr unsigned max_age = 8;
+    // Entries not used for this many calls are erased.
+    static constexpr uint64_t max_idle = 64;
+
+    struct Entry {
+        entt::entity entity;
+        // World space vertices of the triangle that was hit, if the entity
+        // is a mesh. Otherwise, the whole shape is tested.
+        bool has_triangle;
+        std::array<edyn::vector3, 3> vertices;
+        decltype(edyn::shape_raycast_result::info_var) info_var;
+        unsigned age;
+        uint64_t last_used;
+    };
+
+    std::unordered_map<uint64_t, Entry> entries;
+    uint64_t step {};
+
+    static uint64_t key(const BatchRay &ray) {
+        return (uint64_t(entt::to_integral(ray.owner)) << 32) | ray.owner_index;
+    }
+
+    bool find(const CollisionQueryWorld &world, const BatchRay &ray, edyn::raycast_result &result);
+    void store(entt::registry &registry, const BatchRay &ray, const edyn::raycast_result &result);
+    void prune();
+};
+
+struct BatchRaycastContext {
+    // Maximum number of rays in one cluster.
+    static constexpr size_t max_cluster_size = 32;
+    // Clusters stop growing once their bounds get larger than this in any
+    // direction, since a large query AABB returns too many candidates that
+    // most rays in the cluster would miss.
+    static constexpr edyn::scalar max_cluster_extent = 8;
+    // Minimum number of clusters before they're split among the workers of
+    // the task scheduler.
+    static constexpr size_t parallel_threshold = 8;
+    // Rays are only bundled into a packet if the cosine of the angle between
+    // their directions is above this. Otherwise they're tested one by one.
+    static constexpr edyn::scalar packet_coherence = 0.95;
+    static constexpr uint32_t null_lane = UINT32_MAX;
+
+    struct Cluster {
+        size_t first;
+        size_t last;
+        edyn::AABB aabb;
+        // Ranges in `packets` and `single_rays`.
+        size_t first_packet, last_packet;
+        size_t first_single, last_single;
+    };
+
+    struct Candidate {
+        entt::entity entity;
+        edyn::AABB aabb;
+        edyn::vector3 origin;
+        edyn::quaternion orn;
+    };
+
+    std::vector<uint32_t> codes;
+    std::vector<uint32_t> order;
+    std::vector<edyn::AABB> ray_aabbs;
+    std::vector<Cluster> clusters;
+    std::vector<RayPacket4> packets;
+    // Ray index of each lane of each packet.
+    std::vector<uint32_t> packet_rays;
+    std::vector<uint32_t> single_rays;
+    std::vector<Candidate> candidates;
+    std::vector<edyn::raycast_result> results;
+    // Whether each ray was resolved using the hit cache.
+    std::vector<bool> cached;
+    RaycastHitCache cache;
+
+    // Only valid during a call.
+    const CollisionQueryWorld *world;
+    const BatchRay *rays;
+    edyn::raycast_result *results_out;
+
+    void prepare(const BatchRay *rays, size_t count, edyn::raycast_result *results);
+    void makePackets(Cluster &cluster);
+    void updateCache(entt::registry &registry, size_t count);
+    void raycastCluster(const Cluster &cluster, std::vector<Candidate> &candidates);
+
+    // Processes clusters in [start, end). Each cluster only writes the
+    // results of its own rays, thus clusters can run concurrently.
+    void compute(unsigned start, unsigned end) {
+        auto local_candidates = std::vector<Candidate>{};
+
+        for (auto i = start; i < end; ++i) {
+            raycastCluster(clusters[i], local_candidates);
+        }
+    }
+};
+
+// Spreads the lower 10 bits of `v` so there are two zero bits between each.
+static uint32_t ExpandBits(uint32_t v) {
+    v = (v * 0x00010001u) & 0xFF0000FFu;
+    v = (v * 0x00000101u) & 0x0F00F00Fu;
+    v = (v * 0x00000011u) & 0xC30C30C3u;
+    v = (v * 0x00000005u) & 0x49249249u;
+    return v;
+}
+
+static uint32_t MortonCode(const edyn::vector3 &p, const edyn::AABB &bounds) {
+    auto extents = bounds.max - bounds.min;
+    auto code = uint32_t{0};
+
+    for (int i = 0; i < 3; ++i) {
+        auto t = extents[i] > 0 ? (p[i] - bounds.min[i]) / extents[i] : edyn::scalar(0);
+        auto q = static_cast<uint32_t>(std::clamp(t * 1023, edyn::scalar(0), edyn::scalar(1023)));
+        code |= ExpandBits(q) << (2 - i);
+    }
+
+    return code;
+}
+
+void BatchRaycastContext::prepare(const BatchRay *rays, size_t count, edyn::raycast_result *results) {
+    this->rays = rays;
+    results_out = results;
+    ray_aabbs.resize(count);
+    codes.resize(count);
+    order.clear();
+    cached.assign(count, false);
+    clusters.clear();
+    packets.clear();
+    packet_rays.clear();
+    single_rays.clear();
+    ++cache.step;
+
+    auto bounds = edyn::AABB{edyn::vector3_max, -edyn::vector3_max};
+
+    for (size_t i = 0; i < count; ++i) {
+        auto &ray = rays[i];
+        results[i] = {};
+        results[i].entity = entt::null;
+        results[i].fraction = std::numeric_limits<edyn::scalar>::max();
+
+        if (ray.owner != entt::null && cache.find(*world, ray, results[i])) {
+            cached[i] = true;
+            continue;
+        }
+
+        ray_aabbs[i] = {edyn::min(ray.p0, ray.p1), edyn::max(ray.p0, ray.p1)};
+        bounds = edyn::enclosing_aabb(bounds, ray_aabbs[i]);
+        order.push_back(static_cast<uint32_t>(i));
+    }
+
+    for (auto i : order) {
+        auto center = (rays[i].p0 + rays[i].p1) * edyn::scalar(0.5);
+        codes[i] = MortonCode(center, bounds);
+    }
+
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return codes[a] < codes[b];
+    });
+
+    // Group consecutive rays along the curve into clusters.
+    auto num_queried = order.size();
+    size_t first = 0;
+
+    while (first < num_queried) {
+        auto cluster_aabb = ray_aabbs[order[first]];
+        auto last = first + 1;
+
+        while (last < num_queried && last - first < max_cluster_size) {
+            auto merged = edyn::enclosing_aabb(cluster_aabb, ray_aabbs[order[last]]);
+            auto extents = merged.max - merged.min;
+
+            if (std::max({extents.x, extents.y, extents.z}) > max_cluster_extent) {
+                break;
+            }
+
+            cluster_aabb = merged;
+            ++last;
+        }
+
+        auto &cluster = clusters.emplace_back();
+        cluster.first = first;
+        cluster.last = last;
+        cluster.aabb = cluster_aabb;
+        makePackets(cluster);
+        first = last;
+    }
+}
+
+void BatchRaycastContext::makePackets(Cluster &cluster) {
+    cluster.first_packet = packets.size();
+    cluster.first_single = single_rays.size();
+
+    for (auto i = cluster.first; i < cluster.last; i += RayPacket4::size) {
+        auto end = std::min(i + RayPacket4::size, cluster.last);
+        auto &ray0 = rays[order[i]];
+        auto dir0 = ray0.p1 - ray0.p0;
+        auto len_sqr0 = edyn::length_sqr(dir0);
+        auto coherent = end - i > 1 && len_sqr0 > EDYN_EPSILON;
+
+        for (auto j = i + 1; j < end && coherent; ++j) {
+            auto &ray = rays[order[j]];
+            auto dir = ray.p1 - ray.p0;
+            auto len_sqr = edyn::length_sqr(dir);
+            coherent = len_sqr > EDYN_EPSILON &&
+                edyn::dot(dir0, dir) > packet_coherence * std::sqrt(len_sqr0 * len_sqr);
+        }
+
+        if (!coherent) {
+            // The bundle diverges, fall back to single rays.
+            single_rays.insert(single_rays.end(), order.begin() + i, order.begin() + end);
+            continue;
+        }
+
+        auto &packet = packets.emplace_back();
+
+        for (auto j = i; j < i + RayPacket4::size; ++j) {
+            if (j < end) {
+                auto &ray = rays[order[j]];
+                packet.set(static_cast<unsigned>(j - i), ray.p0, ray.p1);
+                packet_rays.push_back(order[j]);
+            } else {
+                packet_rays.push_back(null_lane);
+            }
+        }
+
+        packet.fill();
+    }
+
+    cluster.last_packet = packets.size();
+    cluster.last_single = single_rays.size();
+}
+
+void BatchRaycastContext::raycastCluster(const Cluster &cluster, std::vector<Candidate> &candidates) {
+    // One tree traversal for the whole cluster.
+    candidates.clear();
+    world->bphase->query(cluster.aabb, [&](entt::entity entity) {
+        auto &orn = world->tr_view.get<edyn::orientation>(entity);
+        candidates.push_back({entity, world->aabb_view.get<edyn::AABB>(entity), world->getOrigin(entity), orn});
+    });
+
+    for (auto &candidate : candidates) {
+        auto sh_idx = world->index_view.get<edyn::shape_index>(candidate.entity);
+
+        edyn::visit_shape(sh_idx, candidate.entity, world->shape_views_tuple, [&](auto &&shape) {
+            auto cast = [&](uint32_t ray_idx) {
+                auto &ray = rays[ray_idx];
+
+                if (ray.ignore[0] == candidate.entity || ray.ignore[1] == candidate.entity) {
+                    return;
+                }
+
+                auto rc_ctx = edyn::raycast_context{candidate.origin, candidate.orn, ray.p0, ray.p1};
+                auto shape_result = edyn::shape_raycast(shape, rc_ctx);
+                auto &result = results_out[ray_idx];
+
+                if (shape_result.fraction < result.fraction) {
+                    result.entity = candidate.entity;
+                    result.fraction = shape_result.fraction;
+                    result.normal = shape_result.normal;
+                    result.info_var = shape_result.info_var;
+                }
+            };
+
+            // Four slab tests at once per packet.
+            for (auto p = cluster.first_packet; p < cluster.last_packet; ++p) {
+                auto mask = IntersectRayPacket(packets[p], candidate.aabb);
+
+                for (unsigned lane = 0; mask != 0; ++lane, mask >>= 1) {
+                    if (mask & 1) {
+                        cast(packet_rays[p * RayPacket4::size + lane]);
+                    }
+                }
+            }
+
+            for (auto i = cluster.first_single; i < cluster.last_single; ++i) {
+                auto ray_idx = single_rays[i];
+                auto &ray = rays[ray_idx];
+
+                if (IntersectRaySegment(ray.p0, ray.p1, candidate.aabb)) {
+                    cast(ray_idx);
+                }
+            }
+        });
+    }
+}
+
+// Intersection of segment `p0`-`p1` with a triangle. Returns the fraction
+// along the segment or a negative value if there is no intersection.
+static edyn::scalar IntersectSegmentTriangle(const edyn::vector3 &p0, const edyn::vector3 &p1,
+                                             const std::array<edyn::vector3, 3> &vertices,
+                                             edyn::vector3 &normal) {
+    auto dir = p1 - p0;
+    auto e1 = vertices[1] - vertices[0];
+    auto e2 = vertices[2] - vertices[0];
+    auto h = edyn::cross(dir, e2);
+    auto a = edyn::dot(e1, h);
+
+    if (std::abs(a) < EDYN_EPSILON) {
+        return -1;
+    }
+
+    auto f = edyn::scalar(1) / a;
+    auto s = p0 - vertices[0];
+    auto u = f * edyn::dot(s, h);
+
+    if (u < 0 || u > 1) {
+        return -1;
+    }
+
+    auto q = edyn::cross(s, e1);
+    auto v = f * edyn::dot(dir, q);
+
+    if (v < 0 || u + v > 1) {
+        return -1;
+    }
+
+    auto t = f * edyn::dot(e2, q);
+
+    if (t < 0 || t > 1) {
+        return -1;
+    }
+
+    normal = edyn::normalize(edyn::cross(e1, e2));
+
+    if (edyn::dot(normal, dir) > 0) {
+        normal = -normal;
+    }
+
+    return t;
+}
+
+bool RaycastHitCache::find(const CollisionQueryWorld &world, const BatchRay &ray, edyn::raycast_result &result) {
+    auto it = entries.find(key(ray));
+
+    if (it == entries.end()) {
+        return false;
+    }
+
+    auto &entry = it->second;
+    entry.last_used = step;
+
+    if (entry.age >= max_age || !world.index_view.contains(entry.entity) ||
+        ray.ignore[0] == entry.entity || ray.ignore[1] == entry.entity) {
+        return false;
+    }
+
+    if (entry.has_triangle) {
+        auto normal = edyn::vector3{};
+        auto fraction = IntersectSegmentTriangle(ray.p0, ray.p1, entry.vertices, normal);
+
+        if (fraction < 0) {
+            return false;
+        }
+
+        result.entity = entry.entity;
+        result.fraction = fraction;
+        result.normal = normal;
+        result.info_var = entry.info_var;
+    } else {
+        auto [pos, orn] = world.tr_view.get(entry.entity);
+        auto sh_idx = world.index_view.get<edyn::shape_index>(entry.entity);
+        auto shape_result = edyn::shape_raycast_result{};
+
+        edyn::visit_shape(sh_idx, entry.entity, world.shape_views_tuple, [&](auto &&shape) {
+            auto rc_ctx = edyn::raycast_context{pos, orn, ray.p0, ray.p1};
+            shape_result = edyn::shape_raycast(shape, rc_ctx);
+        });
+
+        if (!(shape_result.fraction <= 1)) {
+            return false;
+        }
+
+        result.entity = entry.entity;
+        result.fraction = shape_result.fraction;
+        result.normal = shape_result.normal;
+        result.info_var = shape_result.info_var;
+    }
+
+    ++entry.age;
+    return true;
+}
+
+void RaycastHitCache::store(entt::registry &registry, const BatchRay &ray, const edyn::raycast_result &result) {
+    if (result.entity == entt::null || !registry.all_of<edyn::static_tag>(result.entity)) {
+        entries.erase(key(ray));
+        return;
+    }
+
+    auto &entry = entries[key(ray)];
+    entry.entity = result.entity;
+    entry.has_triangle = false;
+    entry.info_var = result.info_var;
+    entry.age = 0;
+    entry.last_used = step;
+
+    auto &pos = registry.get<edyn::position>(result.entity);
+    auto &orn = registry.get<edyn::orientation>(result.entity);
+
+    if (auto *info = std::get_if<edyn::mesh_raycast_info>(&result.info_var)) {
+        auto vertices = registry.get<edyn::mesh_shape>(result.entity).trimesh->get_triangle_vertices(info->triangle_index);
+
+        for (int i = 0; i < 3; ++i) {
+            entry.vertices[i] = edyn::to_world_space(vertices[i], pos, orn);
+        }
+
+        entry.has_triangle = true;
+    } else if (auto *info = std::get_if<edyn::paged_mesh_raycast_info>(&result.info_var)) {
+        auto vertices = registry.get<edyn::paged_mesh_shape>(result.entity).trimesh->get_triangle_vertices(info->submesh_index, info->triangle_index);
+
+        for (int i = 0; i < 3; ++i) {
+            entry.vertices[i] = edyn::to_world_space(vertices[i], pos, orn);
+        }
+
+        entry.has_triangle = true;
+    }
+}
+
+void RaycastHitCache::prune() {
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (step - it->second.last_used > max_idle) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void BatchRaycastContext::updateCache(entt::registry &registry, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        if (rays[i].owner != entt::null && !cached[i]) {
+            cache.store(registry, rays[i], results_out[i]);
+        }
+    }
+
+    if (cache.step % RaycastHitCache::max_idle == 0) {
+        cache.prune();
+    }
+}
+
+static BatchRaycastContext &GetBatchRaycastContext(entt::registry &registry) {
+    auto *ctx = registry.ctx().find<BatchRaycastContext>();
+
+    if (ctx == nullptr) {
+        ctx = &registry.ctx().emplace<BatchRaycastContext>();
+    }
+
+    return *ctx;
+}
+
+void BatchRaycast(entt::registry &registry, const BatchRay *rays, size_t count, edyn::raycast_result *results) {
+    if (count == 0) {
+        return;
+    }
+
+    auto &ctx = GetBatchRaycastContext(registry);
+    auto world = CollisionQueryWorld(registry);
+    ctx.world = &world;
+    ctx.prepare(rays, count, results);
+
+    for (auto &cluster : ctx.clusters) {
+        ctx.raycastCluster(cluster, ctx.candidates);
+    }
+
+    ctx.updateCache(registry, count);
+    ctx.world = nullptr;
+}
+
+void BatchRaycastParallel(entt::registry &registry, const BatchRay *rays, size_t count,
+                          BatchRaycastDelegate delegate) {
+    auto &ctx = GetBatchRaycastContext(registry);
+    ctx.results.resize(count);
+
+    if (count > 0) {
+        auto world = CollisionQueryWorld(registry);
+        ctx.world = &world;
+        ctx.prepare(rays, count, ctx.results.data());
+
+        auto num_clusters = static_cast<unsigned>(ctx.clusters.size());
+
+        if (num_clusters >= BatchRaycastContext::parallel_threshold) {
+            auto task = edyn::task_delegate_t(entt::connect_arg_t<&BatchRaycastContext::compute>{}, ctx);
+            auto enqueue_task_wait = edyn::get_enqueue_task_wait(registry);
+            enqueue_task_wait(task, num_clusters);
+        } else {
+            ctx.compute(0, num_clusters);
+        }
+
+        ctx.updateCache(registry, count);
+        ctx.world = nullptr;
+    }
+
+    delegate(rays, ctx.results.data(), count);
+}
@@ -0,0 +1,174 @@
+#include "contact_events.hpp"
+#include <unordered_map>
+#include <edyn/collision/contact_manifold.hpp>
+#include <edyn/collision/contact_point.hpp>
+#include <edyn/comp/tag.hpp>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+struct ContactEventContext {
+    // Events are recorded with the least amount of data available at the
+    // time. Started events only hold the contact entity. Ended events also
+    // hold the manifold and point since the contact won't exist anymore when
+    // polling.
+    struct Record {
+        ContactEventType type;
+        entt::entity contact_entity;
+        entt::entity manifold_entity;
+        std::array<entt::entity, 2> body;
+        edyn::vector3 pivotA;
+        edyn::vector3 normal;
+        uint32_t lifetime;
+    };
+
+    ContactEventSettings settings;
+    std::vector<Record> records;
+    std::vector<ContactEvent> events;
+    // Index of ended records by contact entity, for contacts which started
+    // and ended between polls.
+    std::unordered_map<entt::entity, size_t> ended_index;
+};
+
+static void OnContactStarted(entt::registry &registry, entt::entity entity) {
+    auto &ctx = registry.ctx().get<ContactEventContext>();
+    auto &record = ctx.records.emplace_back();
+    record.type = ContactEventType::Started;
+    record.contact_entity = entity;
+}
+
+static void OnContactPointDestroyed(entt::registry &registry, entt::entity entity) {
+    auto &ctx = registry.ctx().get<ContactEventContext>();
+    auto &cp = registry.get<edyn::contact_point>(entity);
+    auto &record = ctx.records.emplace_back();
+    record.type = ContactEventType::Ended;
+    record.contact_entity = entity;
+    record.manifold_entity = entt::null;
+    record.body = {entt::null, entt::null};
+    record.pivotA = cp.pivotA;
+    record.normal = cp.normal;
+    record.lifetime = cp.lifetime;
+
+    if (auto *cp_list = registry.try_get<edyn::contact_point_list>(entity)) {
+        record.manifold_entity = cp_list->parent;
+
+        if (auto *manifold = registry.try_get<edyn::contact_manifold>(cp_list->parent)) {
+            record.body = manifold->body;
+        }
+    }
+}
+
+void EnableContactEvents(entt::registry &registry, const ContactEventSettings &settings) {
+    if (auto *ctx = registry.ctx().find<ContactEventContext>()) {
+        ctx->settings = settings;
+        return;
+    }
+
+    registry.ctx().emplace<ContactEventContext>().settings = settings;
+    registry.on_construct<edyn::contact_started_tag>().connect<&OnContactStarted>();
+    registry.on_destroy<edyn::contact_point>().connect<&OnContactPointDestroyed>();
+}
+
+void DisableContactEvents(entt::registry &registry) {
+    if (!registry.ctx().contains<ContactEventContext>()) {
+        return;
+    }
+
+    registry.on_construct<edyn::contact_started_tag>().disconnect<&OnContactStarted>();
+    registry.on_destroy<edyn::contact_point>().disconnect<&OnContactPointDestroyed>();
+    registry.ctx().erase<ContactEventContext>();
+}
+
+static void ResolveBodies(entt::registry &registry, ContactEvent &event, const edyn::vector3 &pivotA) {
+    auto material_view = registry.view<edyn::material>();
+
+    for (int i = 0; i < 2; ++i) {
+        if (material_view.contains(event.body[i])) {
+            event.material_id[i] = material_view.get<edyn::material>(event.body[i]).id;
+        }
+    }
+
+    if (registry.valid(event.body[0]) && registry.all_of<edyn::orientation>(event.body[0])) {
+        auto posA = edyn::get_rigidbody_origin(registry, event.body[0]);
+        auto &ornA = registry.get<edyn::orientation>(event.body[0]);
+        event.point = edyn::to_world_space(pivotA, posA, ornA);
+    }
+}
+
+static ContactEvent ResolveContact(entt::registry &registry, ContactEventType type, entt::entity contact_entity,
+                                   const edyn::contact_point &cp, const edyn::contact_point_list &cp_list,
+                                   const edyn::contact_point_impulse &cp_imp) {
+    auto event = ContactEvent{};
+    event.type = type;
+    event.contact_entity = contact_entity;
+    event.manifold_entity = cp_list.parent;
+    event.normal = cp.normal;
+    event.lifetime = cp.lifetime;
+    event.normal_impulse = cp_imp.normal_impulse + cp_imp.normal_restitution_impulse;
+
+    if (auto *manifold = registry.try_get<edyn::contact_manifold>(cp_list.parent)) {
+        event.body = manifold->body;
+    }
+
+    ResolveBodies(registry, event, cp.pivotA);
+    return event;
+}
+
+const std::vector<ContactEvent> &PollContactEvents(entt::registry &registry) {
+    auto &ctx = registry.ctx().get<ContactEventContext>();
+    auto cp_view = registry.view<edyn::contact_point, edyn::contact_point_list, edyn::contact_point_impulse>();
+    ctx.events.clear();
+    ctx.ended_index.clear();
+
+    for (size_t i = 0; i < ctx.records.size(); ++i) {
+        if (ctx.records[i].type == ContactEventType::Ended) {
+            ctx.ended_index[ctx.records[i].contact_entity] = i;
+        }
+    }
+
+    for (auto &record : ctx.records) {
+        if (record.type == ContactEventType::Started) {
+            if (cp_view.contains(record.contact_entity)) {
+                auto [cp, cp_list, cp_imp] = cp_view.get(record.contact_entity);
+                ctx.events.push_back(ResolveContact(registry, record.type, record.contact_entity, cp, cp_list, cp_imp));
+                continue;
+            }
+
+            // Already gone. Use what was recorded when it ended.
+            auto it = ctx.ended_index.find(record.contact_entity);
+
+            if (it == ctx.ended_index.end()) {
+                continue;
+            }
+
+            auto &ended = ctx.records[it->second];
+            auto &event = ctx.events.emplace_back();
+            event.type = ContactEventType::Started;
+            event.contact_entity = record.contact_entity;
+            event.manifold_entity = ended.manifold_entity;
+            event.body = ended.body;
+            event.normal = ended.normal;
+            ResolveBodies(registry, event, ended.pivotA);
+        } else {
+            auto &event = ctx.events.emplace_back();
+            event.type = ContactEventType::Ended;
+            event.contact_entity = record.contact_entity;
+            event.manifold_entity = record.manifold_entity;
+            event.body = record.body;
+            event.normal = record.normal;
+            event.lifetime = record.lifetime;
+            ResolveBodies(registry, event, record.pivotA);
+        }
+    }
+
+    ctx.records.clear();
+
+    if (ctx.settings.impulse_threshold > 0) {
+        for (auto [entity, cp, cp_list, cp_imp] : cp_view.each()) {
+            if (cp_imp.normal_impulse + cp_imp.normal_restitution_impulse > ctx.settings.impulse_threshold) {
+                ctx.events.push_back(ResolveContact(registry, ContactEventType::Impulse, entity, cp, cp_list, cp_imp));
+            }
+        }
+    }
+
+    return ctx.events;
+}
@@ -0,0 +1,147 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string &path) {
+    close();
+
+    auto file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    auto mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+
+    auto *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (data == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const uint8_t *>(data);
+    m_size = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+        CloseHandle(m_file);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_file = nullptr;
+    m_mapping = nullptr;
+}
+
+void MappedFile::willNeed(size_t offset, size_t length) const {
+    if (m_data == nullptr || offset >= m_size) {
+        return;
+    }
+
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<uint8_t *>(m_data + offset);
+    range.NumberOfBytes = length < m_size - offset ? length : m_size - offset;
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+void MappedFile::dontNeed(size_t, size_t) const {}
+
+#else
+
+bool MappedFile::open(const std::string &path) {
+    close();
+
+    auto fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    auto *data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+
+    if (data == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    m_fd = fd;
+    m_data = static_cast<const uint8_t *>(data);
+    m_size = static_cast<size_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data != nullptr) {
+        munmap(const_cast<uint8_t *>(m_data), m_size);
+        ::close(m_fd);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_fd = -1;
+}
+
+// Ranges given to `madvise` must start at a page boundary.
+static void Advise(const uint8_t *data, size_t size, size_t offset, size_t length, int advice) {
+    if (data == nullptr || offset >= size) {
+        return;
+    }
+
+    auto page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    auto begin = offset / page_size * page_size;
+    auto end = offset + (length < size - offset ? length : size - offset);
+    madvise(const_cast<uint8_t *>(data + begin), end - begin, advice);
+}
+
+void MappedFile::willNeed(size_t offset, size_t length) const {
+    Advise(m_data, m_size, offset, length, MADV_WILLNEED);
+}
+
+void MappedFile::dontNeed(size_t offset, size_t length) const {
+    Advise(m_data, m_size, offset, length, MADV_DONTNEED);
+}
+
+#endif
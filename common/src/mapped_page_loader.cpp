@@ -0,0 +1,317 @@
+#include "mapped_page_loader.hpp"
+#include "async_log.hpp"
+#include "baked_asset.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <edyn/serialization/memory_archive.hpp>
+#include <edyn/serialization/paged_triangle_mesh_s11n.hpp>
+#include <edyn/edyn.hpp>
+
+static uint64_t AlignUp(uint64_t value, uint64_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static bool ComputeFileChecksum(const std::string &path, uint64_t &size, uint64_t &checksum) {
+    auto file = MappedFile{};
+
+    if (!file.open(path)) {
+        return false;
+    }
+
+    size = file.size();
+    checksum = ComputeChecksum(file.data(), file.size());
+    return true;
+}
+
+bool WriteMappedPageFile(const std::string &path, const std::string &structure_path,
+                         edyn::paged_triangle_mesh &paged_trimesh,
+                         PageCodec codec, const PageCodecSettings &codec_settings) {
+    auto num_pages = paged_trimesh.number_of_submeshes();
+    auto header = MappedPageFileHeader{};
+    header.codec = codec;
+    header.num_pages = num_pages;
+
+    if (!ComputeFileChecksum(structure_path, header.structure_size, header.structure_checksum)) {
+        return false;
+    }
+    auto alignment = codec == PageCodec::Raw ?
+        MappedPageFileHeader::page_alignment : MappedPageFileHeader::encoded_page_alignment;
+
+    auto entries = std::vector<MappedPageEntry>(num_pages);
+    auto blobs = std::vector<std::vector<uint8_t>>(num_pages);
+    auto offset = AlignUp(sizeof(header) + sizeof(MappedPageEntry) * num_pages, alignment);
+
+    for (size_t i = 0; i < num_pages; ++i) {
+        auto trimesh = paged_trimesh.get_submesh(i);
+
+        if (!trimesh) {
+            return false;
+        }
+
+        if (codec == PageCodec::Raw) {
+            auto archive = edyn::memory_output_archive(blobs[i]);
+            edyn::serialize(archive, *trimesh);
+        } else {
+            EncodePage(*trimesh, codec_settings, blobs[i]);
+        }
+
+        auto aabb = edyn::AABB{edyn::vector3_max, -edyn::vector3_max};
+
+        for (size_t j = 0; j < trimesh->num_triangles(); ++j) {
+            for (auto &v : trimesh->get_triangle_vertices(j)) {
+                aabb.min = edyn::min(aabb.min, v);
+                aabb.max = edyn::max(aabb.max, v);
+            }
+        }
+
+        auto &entry = entries[i];
+        entry.offset = offset;
+        entry.size = blobs[i].size();
+        entry.checksum = ComputeChecksum(blobs[i].data(), blobs[i].size());
+
+        for (int k = 0; k < 3; ++k) {
+            entry.aabb_min[k] = static_cast<float>(aabb.min[k]);
+            entry.aabb_max[k] = static_cast<float>(aabb.max[k]);
+        }
+
+        offset = AlignUp(offset + blobs[i].size(), alignment);
+    }
+
+    auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+
+    if (!file) {
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(entries.data()), sizeof(MappedPageEntry) * num_pages);
+
+    static const char padding[MappedPageFileHeader::page_alignment] = {};
+
+    for (size_t i = 0; i < num_pages; ++i) {
+        auto position = static_cast<uint64_t>(file.tellp());
+        file.write(padding, entries[i].offset - position);
+        file.write(reinterpret_cast<const char *>(blobs[i].data()), blobs[i].size());
+    }
+
+    return static_cast<bool>(file);
+}
+
+MappedPageLoader::MappedPageLoader(edyn::enqueue_task_t *enqueue_task)
+    : m_enqueue_task(enqueue_task)
+{}
+
+MappedPageLoader::~MappedPageLoader() {
+    close();
+}
+
+bool MappedPageLoader::open(const std::string &path, const std::string &structure_path) {
+    close();
+
+    if (!m_file.open(path)) {
+        return false;
+    }
+
+    auto header = MappedPageFileHeader{};
+    auto valid = m_file.size() >= sizeof(header);
+
+    if (valid) {
+        std::memcpy(&header, m_file.data(), sizeof(header));
+        valid = std::memcmp(header.magic, MappedPageFileHeader{}.magic, sizeof(header.magic)) == 0 &&
+                header.version == MappedPageFileHeader::current_version &&
+                (header.codec == PageCodec::Raw || header.codec == PageCodec::Quantized) &&
+                m_file.size() >= sizeof(header) + sizeof(MappedPageEntry) * header.num_pages;
+    }
+
+    if (valid) {
+        auto structure_size = uint64_t{}, structure_checksum = uint64_t{};
+        valid = ComputeFileChecksum(structure_path, structure_size, structure_checksum) &&
+                structure_size == header.structure_size &&
+                structure_checksum == header.structure_checksum;
+    }
+
+    if (valid) {
+        m_codec = header.codec;
+        m_entries.resize(header.num_pages);
+        std::memcpy(m_entries.data(), m_file.data() + sizeof(header), sizeof(MappedPageEntry) * header.num_pages);
+
+        for (auto &entry : m_entries) {
+            valid = valid && entry.offset + entry.size <= m_file.size();
+        }
+    }
+
+    if (valid) {
+        m_page_state.assign(m_entries.size(), PageState::Idle);
+    } else {
+        close();
+    }
+
+    return valid;
+}
+
+void MappedPageLoader::close() {
+    {
+        // Tasks still queued find nothing to load and return.
+        std::unique_lock lock(m_pending_mutex);
+        m_pending.clear();
+        m_pending_prefetch.clear();
+        m_tasks_done.wait(lock, [&] { return m_num_tasks == 0; });
+    }
+
+    m_file.close();
+    m_entries.clear();
+    m_page_state.clear();
+}
+
+edyn::AABB MappedPageLoader::pageAABB(size_t index) const {
+    auto &entry = m_entries[index];
+    return {
+        {entry.aabb_min[0], entry.aabb_min[1], entry.aabb_min[2]},
+        {entry.aabb_max[0], entry.aabb_max[1], entry.aabb_max[2]}
+    };
+}
+
+void MappedPageLoader::load(size_t index) {
+    {
+        std::lock_guard lock(m_pending_mutex);
+        auto &state = m_page_state[index];
+
+        if (state == PageState::Prefetching) {
+            // Prediction was right but not early enough. The prefetch will
+            // deliver the page, thus there's no need to load it again, but
+            // if it hasn't started yet it must not wait behind the other
+            // prefetches.
+            ++m_num_late_loads;
+
+            state = PageState::Loading;
+            auto it = std::find(m_pending_prefetch.begin(), m_pending_prefetch.end(), index);
+
+            if (it != m_pending_prefetch.end()) {
+                m_pending_prefetch.erase(it);
+                m_pending.push_front(index);
+            }
+
+            return;
+        }
+
+        ++m_num_misses;
+
+        if (state == PageState::Loading) {
+            return;
+        }
+
+        state = PageState::Loading;
+
+        if (m_enqueue_task != nullptr) {
+            m_pending.push_back(index);
+        }
+    }
+
+    if (m_enqueue_task == nullptr) {
+        loadPage(index);
+    } else {
+        enqueue();
+    }
+}
+
+bool MappedPageLoader::prefetch(size_t index) {
+    {
+        std::lock_guard lock(m_pending_mutex);
+        auto &state = m_page_state[index];
+
+        if (state != PageState::Idle) {
+            return false;
+        }
+
+        state = PageState::Prefetching;
+
+        if (m_enqueue_task != nullptr) {
+            m_pending_prefetch.push_back(index);
+        }
+    }
+
+    if (m_enqueue_task == nullptr) {
+        loadPage(index);
+    } else {
+        enqueue();
+    }
+
+    return true;
+}
+
+bool MappedPageLoader::isLoading(size_t index) const {
+    std::lock_guard lock(m_pending_mutex);
+    return m_page_state[index] != PageState::Idle;
+}
+
+void MappedPageLoader::enqueue() {
+    {
+        std::lock_guard lock(m_pending_mutex);
+        ++m_num_tasks;
+    }
+
+    // The paged mesh might be holding locks while requesting a load and
+    // expects the result to come later, as with the file archive.
+    auto task = edyn::task_delegate_t(entt::connect_arg_t<&MappedPageLoader::loadPending>{}, *this);
+    (*m_enqueue_task)(task, 1, {});
+}
+
+void MappedPageLoader::loadPending(unsigned, unsigned) {
+    auto index = size_t{};
+    auto found = false;
+
+    {
+        // One task is enqueued per pending page, thus there's always one
+        // here unless the loader was closed. Taking a single page per task
+        // lets pages load in parallel.
+        std::lock_guard lock(m_pending_mutex);
+        auto &queue = m_pending.empty() ? m_pending_prefetch : m_pending;
+
+        if (!queue.empty()) {
+            index = queue.front();
+            queue.pop_front();
+            found = true;
+        }
+    }
+
+    if (found) {
+        loadPage(index);
+    }
+
+    std::lock_guard lock(m_pending_mutex);
+    --m_num_tasks;
+    m_tasks_done.notify_all();
+}
+
+void MappedPageLoader::loadPage(size_t index) {
+    auto &entry = m_entries[index];
+    auto *data = m_file.data() + entry.offset;
+    auto trimesh = std::make_unique<edyn::triangle_mesh>();
+    auto valid = ComputeChecksum(data, entry.size) == entry.checksum;
+
+    if (valid && m_codec == PageCodec::Raw) {
+        auto archive = edyn::memory_input_archive(data, entry.size);
+        edyn::serialize(archive, *trimesh);
+    } else if (valid) {
+        valid = DecodePage(data, entry.size, *trimesh);
+    }
+
+    if (!valid) {
+        // The paged mesh waits for every page it requests, thus publish an
+        // empty one instead.
+        Log("Malformed page %zu.", index);
+        trimesh = std::make_unique<edyn::triangle_mesh>();
+        trimesh->initialize();
+    }
+
+    m_loaded_mesh_signal.publish(index, trimesh);
+
+    std::lock_guard lock(m_pending_mutex);
+    m_page_state[index] = PageState::Idle;
+}
+
+entt::sink<entt::sigh<MappedPageLoader::loaded_mesh_func_t>> MappedPageLoader::on_load_sink() {
+    return {m_loaded_mesh_signal};
+}
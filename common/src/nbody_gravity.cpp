@@ -0,0 +1,247 @@
+#include "nbody_gravity.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+#include <edyn/context/task.hpp>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+struct NBodyOctree {
+    // Maximum number of bodies in a leaf.
+    static constexpr uint32_t max_leaf_size = 8;
+    // Coincident bodies would otherwise subdivide forever.
+    static constexpr unsigned max_depth = 32;
+
+    struct Node {
+        edyn::vector3 center_of_mass;
+        edyn::scalar mass;
+        edyn::vector3 center;
+        edyn::scalar half_size;
+        // Index of the first of eight consecutive children. Zero for leaves
+        // since the root is never a child.
+        uint32_t first_child;
+        // Range of the bodies in this node in `order`.
+        uint32_t begin, end;
+    };
+
+    std::vector<Node> nodes;
+    // Body indices sorted such that the bodies of each node are contiguous.
+    std::vector<uint32_t> order;
+
+    void build(const std::vector<edyn::vector3> &positions, const std::vector<edyn::scalar> &masses) {
+        auto count = static_cast<uint32_t>(positions.size());
+        order.resize(count);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            order[i] = i;
+        }
+
+        auto min = edyn::vector3_max, max = -edyn::vector3_max;
+
+        for (auto &pos : positions) {
+            min = edyn::min(min, pos);
+            max = edyn::max(max, pos);
+        }
+
+        // Use a cube so nodes never get too elongated.
+        auto extents = max - min;
+        auto half_size = std::max({extents.x, extents.y, extents.z, edyn::scalar(1e-3)}) * edyn::scalar(0.5);
+
+        nodes.clear();
+        nodes.push_back(Node{edyn::vector3_zero, 0, (min + max) * edyn::scalar(0.5), half_size, 0, 0, count});
+        subdivide(0, 0, positions, masses);
+    }
+
+    void subdivide(uint32_t node_idx, unsigned depth,
+                   const std::vector<edyn::vector3> &positions, const std::vector<edyn::scalar> &masses) {
+        auto node = nodes[node_idx];
+
+        if (node.end - node.begin <= max_leaf_size || depth == max_depth) {
+            auto mass = edyn::scalar(0);
+            auto moment = edyn::vector3_zero;
+
+            for (auto k = node.begin; k < node.end; ++k) {
+                mass += masses[order[k]];
+                moment += positions[order[k]] * masses[order[k]];
+            }
+
+            nodes[node_idx].mass = mass;
+            nodes[node_idx].center_of_mass = mass > 0 ? moment / mass : node.center;
+            return;
+        }
+
+        // Split the range in octants, first by x, then each half by y and
+        // each quarter by z. Octant index bits are (x, y, z) from highest.
+        auto *first = order.data() + node.begin;
+        auto *last = order.data() + node.end;
+        auto split = [&](uint32_t *begin, uint32_t *end, int axis) {
+            return std::partition(begin, end, [&](uint32_t i) { return positions[i][axis] < node.center[axis]; });
+        };
+
+        std::array<uint32_t *, 9> bounds;
+        bounds[0] = first;
+        bounds[8] = last;
+        bounds[4] = split(first, last, 0);
+        bounds[2] = split(bounds[0], bounds[4], 1);
+        bounds[6] = split(bounds[4], bounds[8], 1);
+
+        for (int i = 0; i < 8; i += 2) {
+            bounds[i + 1] = split(bounds[i], bounds[i + 2], 2);
+        }
+
+        auto first_child = static_cast<uint32_t>(nodes.size());
+        auto child_half_size = node.half_size * edyn::scalar(0.5);
+        nodes[node_idx].first_child = first_child;
+
+        for (int i = 0; i < 8; ++i) {
+            auto offset = edyn::vector3{i & 4 ? child_half_size : -child_half_size,
+                                        i & 2 ? child_half_size : -child_half_size,
+                                        i & 1 ? child_half_size : -child_half_size};
+            auto begin = static_cast<uint32_t>(bounds[i] - order.data());
+            auto end = static_cast<uint32_t>(bounds[i + 1] - order.data());
+            nodes.push_back(Node{edyn::vector3_zero, 0, node.center + offset, child_half_size, 0, begin, end});
+        }
+
+        auto mass = edyn::scalar(0);
+        auto moment = edyn::vector3_zero;
+
+        for (uint32_t i = 0; i < 8; ++i) {
+            auto child_idx = first_child + i;
+
+            if (nodes[child_idx].begin != nodes[child_idx].end) {
+                subdivide(child_idx, depth + 1, positions, masses);
+            }
+
+            // Nodes vector might have been reallocated.
+            mass += nodes[child_idx].mass;
+            moment += nodes[child_idx].center_of_mass * nodes[child_idx].mass;
+        }
+
+        nodes[node_idx].mass = mass;
+        nodes[node_idx].center_of_mass = mass > 0 ? moment / mass : node.center;
+    }
+};
+
+struct NBodyGravityContext {
+    // Minimum number of bodies before they're split among the workers of the
+    // task scheduler.
+    static constexpr size_t parallel_threshold = 256;
+
+    std::vector<entt::entity> entities;
+    std::vector<edyn::vector3> positions;
+    std::vector<edyn::scalar> masses;
+    std::vector<edyn::vector3> accelerations;
+    NBodyOctree tree;
+    NBodyGravity settings;
+
+    edyn::vector3 acceleration(uint32_t body_idx) const {
+        auto pos = positions[body_idx];
+        auto theta_sqr = settings.theta * settings.theta;
+        auto softening_sqr = settings.softening * settings.softening;
+        auto accel = edyn::vector3_zero;
+
+        auto pull = [&](const edyn::vector3 &other_pos, edyn::scalar other_mass) {
+            auto d = other_pos - pos;
+            auto dist_sqr = edyn::length_sqr(d) + softening_sqr;
+            accel += d * (other_mass / (dist_sqr * std::sqrt(dist_sqr)));
+        };
+
+        std::array<uint32_t, NBodyOctree::max_depth * 7 + 8> stack;
+        size_t stack_size = 0;
+        stack[stack_size++] = 0;
+
+        while (stack_size > 0) {
+            auto &node = tree.nodes[stack[--stack_size]];
+
+            if (node.begin == node.end) {
+                continue;
+            }
+
+            if (node.first_child == 0) {
+                for (auto k = node.begin; k < node.end; ++k) {
+                    auto other_idx = tree.order[k];
+
+                    if (other_idx != body_idx) {
+                        pull(positions[other_idx], masses[other_idx]);
+                    }
+                }
+                continue;
+            }
+
+            // Always open nodes containing this body so it never pulls
+            // itself.
+            auto to_center = pos - node.center;
+            auto inside = std::abs(to_center.x) <= node.half_size &&
+                          std::abs(to_center.y) <= node.half_size &&
+                          std::abs(to_center.z) <= node.half_size;
+            auto size = node.half_size * 2;
+
+            if (!inside && size * size < theta_sqr * edyn::distance_sqr(pos, node.center_of_mass)) {
+                pull(node.center_of_mass, node.mass);
+            } else {
+                for (uint32_t i = 0; i < 8; ++i) {
+                    stack[stack_size++] = node.first_child + i;
+                }
+            }
+        }
+
+        return accel * settings.gravitational_constant;
+    }
+
+    void compute(unsigned start, unsigned end) {
+        for (auto i = start; i < end; ++i) {
+            accelerations[i] = acceleration(i);
+        }
+    }
+};
+
+void ApplyNBodyGravity(entt::registry &registry) {
+    auto settings_view = registry.view<NBodyGravity>();
+
+    if (settings_view.empty()) {
+        return;
+    }
+
+    auto *ctx = registry.ctx().find<NBodyGravityContext>();
+
+    if (ctx == nullptr) {
+        ctx = &registry.ctx().emplace<NBodyGravityContext>();
+    }
+
+    ctx->settings = settings_view.get<NBodyGravity>(settings_view.front());
+    ctx->entities.clear();
+    ctx->positions.clear();
+    ctx->masses.clear();
+
+    auto body_view = registry.view<edyn::position, edyn::mass, edyn::linvel, edyn::dynamic_tag>();
+
+    for (auto [entity, pos, mass, linvel] : body_view.each()) {
+        ctx->entities.push_back(entity);
+        ctx->positions.push_back(pos);
+        ctx->masses.push_back(mass);
+    }
+
+    if (ctx->entities.size() < 2) {
+        return;
+    }
+
+    ctx->tree.build(ctx->positions, ctx->masses);
+    ctx->accelerations.resize(ctx->entities.size());
+
+    auto num_bodies = static_cast<unsigned>(ctx->entities.size());
+
+    if (num_bodies >= NBodyGravityContext::parallel_threshold) {
+        auto task = edyn::task_delegate_t(entt::connect_arg_t<&NBodyGravityContext::compute>{}, *ctx);
+        auto enqueue_task_wait = edyn::get_enqueue_task_wait(registry);
+        enqueue_task_wait(task, num_bodies);
+    } else {
+        ctx->compute(0, num_bodies);
+    }
+
+    auto dt = edyn::get_fixed_dt(registry);
+
+    for (unsigned i = 0; i < num_bodies; ++i) {
+        body_view.get<edyn::linvel>(ctx->entities[i]) += ctx->accelerations[i] * dt;
+    }
+}
@@ -0,0 +1,323 @@
+#include "obj_loader.hpp"
+#include "mapped_file.hpp"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+static bool IsSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static const char *SkipSpaces(const char *p, const char *end) {
+    while (p != end && IsSpace(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+static bool IsDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+// Parses a decimal floating point number, which is all OBJ files contain.
+// Not correctly rounded in every case like `strtod`, but the error is far
+// below what matters for geometry and it doesn't depend on the locale.
+static const char *ParseFloat(const char *p, const char *end, double &value) {
+    static const double powers[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    auto negative = false;
+
+    if (p != end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+    auto num_digits = 0;
+
+    for (; p != end && IsDigit(*p); ++p, ++num_digits) {
+        if (mantissa < 1000000000000000000ull) {
+            mantissa = mantissa * 10 + uint64_t(*p - '0');
+        } else {
+            ++exponent;
+        }
+    }
+
+    if (p != end && *p == '.') {
+        for (++p; p != end && IsDigit(*p); ++p, ++num_digits) {
+            if (mantissa < 1000000000000000000ull) {
+                mantissa = mantissa * 10 + uint64_t(*p - '0');
+                --exponent;
+            }
+        }
+    }
+
+    if (num_digits == 0) {
+        return nullptr;
+    }
+
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        auto q = p + 1;
+        auto negative_exponent = false;
+
+        if (q != end && (*q == '-' || *q == '+')) {
+            negative_exponent = *q == '-';
+            ++q;
+        }
+
+        if (q != end && IsDigit(*q)) {
+            int e = 0;
+
+            for (; q != end && IsDigit(*q); ++q) {
+                e = std::min(e * 10 + (*q - '0'), 10000);
+            }
+
+            exponent += negative_exponent ? -e : e;
+            p = q;
+        }
+    }
+
+    value = double(mantissa);
+
+    if (exponent < 0) {
+        value = -exponent <= 22 ? value / powers[-exponent] : value * std::pow(10.0, exponent);
+    } else if (exponent > 0) {
+        value = exponent <= 22 ? value * powers[exponent] : value * std::pow(10.0, exponent);
+    }
+
+    if (negative) {
+        value = -value;
+    }
+
+    return p;
+}
+
+static const char *ParseInt(const char *p, const char *end, int64_t &value) {
+    auto negative = false;
+
+    if (p != end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    if (p == end || !IsDigit(*p)) {
+        return nullptr;
+    }
+
+    value = 0;
+
+    for (; p != end && IsDigit(*p); ++p) {
+        value = value * 10 + (*p - '0');
+    }
+
+    if (negative) {
+        value = -value;
+    }
+
+    return p;
+}
+
+struct ObjChunk {
+    const char *begin;
+    const char *end;
+    std::vector<edyn::vector3> vertices;
+    // Absolute zero-based indices are stored as non-negative values. Indices
+    // relative to the end of the vertex list are resolved against the start
+    // of this chunk, which can be negative if referring to a previous chunk,
+    // and stored minus `relative_bias`, since the number of vertices in
+    // previous chunks isn't known while parsing.
+    static constexpr int64_t relative_bias = int64_t(1) << 40;
+    std::vector<int64_t> indices;
+    size_t vertex_offset;
+    size_t index_offset;
+    bool valid {true};
+
+    void parseLine(const char *p, const char *line_end, std::vector<int64_t> &polygon) {
+        p = SkipSpaces(p, line_end);
+
+        if (line_end - p < 2 || !IsSpace(p[1])) {
+            return;
+        }
+
+        if (p[0] == 'v') {
+            double coords[3];
+            p += 1;
+
+            for (auto &c : coords) {
+                p = ParseFloat(SkipSpaces(p, line_end), line_end, c);
+
+                if (!p) {
+                    valid = false;
+                    return;
+                }
+            }
+
+            vertices.push_back({
+                static_cast<edyn::scalar>(coords[0]),
+                static_cast<edyn::scalar>(coords[1]),
+                static_cast<edyn::scalar>(coords[2])
+            });
+        } else if (p[0] == 'f') {
+            polygon.clear();
+            p = SkipSpaces(p + 1, line_end);
+
+            while (p != line_end) {
+                int64_t index;
+                p = ParseInt(p, line_end, index);
+
+                if (!p || index == 0) {
+                    valid = false;
+                    return;
+                }
+
+                if (index > 0) {
+                    polygon.push_back(index - 1);
+                } else {
+                    auto local = int64_t(vertices.size()) + index;
+                    polygon.push_back(local - relative_bias);
+                }
+
+                // Skip texture coordinate and normal indices.
+                while (p != line_end && !IsSpace(*p)) {
+                    ++p;
+                }
+
+                p = SkipSpaces(p, line_end);
+            }
+
+            for (size_t i = 2; i < polygon.size(); ++i) {
+                indices.push_back(polygon[0]);
+                indices.push_back(polygon[i - 1]);
+                indices.push_back(polygon[i]);
+            }
+        }
+    }
+
+    void parse() {
+        auto polygon = std::vector<int64_t>{};
+
+        for (auto p = begin; p != end;) {
+            auto line_end = std::find(p, end, '\n');
+            parseLine(p, line_end, polygon);
+            p = line_end == end ? end : line_end + 1;
+        }
+    }
+};
+
+struct ObjLoadContext {
+    std::vector<ObjChunk> chunks;
+    std::vector<edyn::vector3> *vertices;
+    std::vector<uint32_t> *indices;
+
+    void parse(unsigned start, unsigned end) {
+        for (auto i = start; i < end; ++i) {
+            chunks[i].parse();
+        }
+    }
+
+    void merge(unsigned start, unsigned end) {
+        auto num_vertices = int64_t(vertices->size());
+
+        for (auto i = start; i < end; ++i) {
+            auto &chunk = chunks[i];
+            std::copy(chunk.vertices.begin(), chunk.vertices.end(),
+                      vertices->begin() + chunk.vertex_offset);
+
+            auto out = indices->begin() + chunk.index_offset;
+
+            for (auto index : chunk.indices) {
+                if (index < 0) {
+                    index = int64_t(chunk.vertex_offset) + index + ObjChunk::relative_bias;
+                }
+
+                if (index < 0 || index >= num_vertices) {
+                    chunk.valid = false;
+                    index = 0;
+                }
+
+                *out++ = static_cast<uint32_t>(index);
+            }
+        }
+    }
+};
+
+bool LoadTriMeshFromObj(const std::string &path,
+                        std::vector<edyn::vector3> &vertices,
+                        std::vector<uint32_t> &indices,
+                        edyn::enqueue_task_wait_t *enqueue_task_wait) {
+    auto file = MappedFile{};
+
+    if (!file.open(path)) {
+        return false;
+    }
+
+    auto *data = reinterpret_cast<const char *>(file.data());
+    auto *data_end = data + file.size();
+    file.willNeed(0, file.size());
+
+    // Chunks large enough for parsing to dominate the cost of a task, and
+    // a few per worker to balance the load since some will be slower.
+    const size_t min_chunk_size = 1 << 20;
+    auto num_workers = std::max(std::thread::hardware_concurrency(), 1u);
+    auto num_chunks = enqueue_task_wait ?
+        std::clamp(file.size() / min_chunk_size, size_t(1), size_t(num_workers) * 4) : size_t(1);
+    auto chunk_size = file.size() / num_chunks;
+
+    vertices.clear();
+    indices.clear();
+
+    auto ctx = ObjLoadContext{};
+    ctx.vertices = &vertices;
+    ctx.indices = &indices;
+    ctx.chunks.resize(num_chunks);
+
+    for (size_t i = 0; i < num_chunks; ++i) {
+        auto &chunk = ctx.chunks[i];
+        chunk.begin = i == 0 ? data : ctx.chunks[i - 1].end;
+
+        if (i + 1 == num_chunks) {
+            chunk.end = data_end;
+        } else {
+            // Split right after the next line break.
+            auto split = std::max(chunk.begin, std::min(data + chunk_size * (i + 1), data_end));
+            split = std::find(split, data_end, '\n');
+            chunk.end = split == data_end ? data_end : split + 1;
+        }
+    }
+
+    if (enqueue_task_wait) {
+        auto task = edyn::task_delegate_t(entt::connect_arg_t<&ObjLoadContext::parse>{}, ctx);
+        enqueue_task_wait(task, static_cast<unsigned>(num_chunks));
+    } else {
+        ctx.parse(0, static_cast<unsigned>(num_chunks));
+    }
+
+    size_t num_vertices = 0, num_indices = 0;
+
+    for (auto &chunk : ctx.chunks) {
+        if (!chunk.valid) {
+            return false;
+        }
+
+        chunk.vertex_offset = num_vertices;
+        chunk.index_offset = num_indices;
+        num_vertices += chunk.vertices.size();
+        num_indices += chunk.indices.size();
+    }
+
+    vertices.resize(num_vertices);
+    indices.resize(num_indices);
+
+    if (enqueue_task_wait) {
+        auto task = edyn::task_delegate_t(entt::connect_arg_t<&ObjLoadContext::merge>{}, ctx);
+        enqueue_task_wait(task, static_cast<unsigned>(num_chunks));
+    } else {
+        ctx.merge(0, static_cast<unsigned>(num_chunks));
+    }
+
+    return std::all_of(ctx.chunks.begin(), ctx.chunks.end(), [](auto &chunk) { return chunk.valid; });
+}
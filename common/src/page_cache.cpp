@@ -0,0 +1,180 @@
+#include "page_cache.hpp"
+#include "mapped_page_loader.hpp"
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <edyn/edyn.hpp>
+#include <edyn/time/time.hpp>
+
+struct PageCacheEntry {
+    // Zero if not resident.
+    size_t bytes {};
+    size_t num_vertices {};
+    double eviction_time {-std::numeric_limits<double>::infinity()};
+};
+
+struct PageCacheContext {
+    entt::entity mesh_entity;
+    std::shared_ptr<MappedPageLoader> loader;
+    PageCacheSettings settings;
+    PageCacheStats stats;
+    std::vector<PageCacheEntry> entries;
+    size_t previous_max_cache_num_vertices;
+    double last_update_time;
+};
+
+size_t GetTriangleMeshMemoryUsage(const edyn::triangle_mesh &trimesh) {
+    // Mirrors the arrays held by `edyn::triangle_mesh`.
+    size_t num_vertices = trimesh.num_vertices();
+    size_t num_edges = trimesh.num_edges();
+    size_t num_triangles = trimesh.num_triangles();
+
+    auto per_vertex = sizeof(edyn::vector3) * 2; // Position and tangent.
+    auto per_edge = sizeof(uint32_t) * 2 + // Vertex indices.
+                    sizeof(uint32_t) * 2 + // Face indices.
+                    sizeof(edyn::vector3) * 2; // Normals.
+    auto per_triangle = sizeof(uint32_t) * 3 + // Vertex indices.
+                        sizeof(uint32_t) * 3 + // Edge indices.
+                        sizeof(edyn::vector3); // Normal.
+    // The tree is a complete binary tree with one triangle per leaf.
+    auto per_tree_node = sizeof(edyn::AABB) + sizeof(uint32_t) * 2;
+
+    if (trimesh.has_per_vertex_friction()) {
+        per_vertex += sizeof(edyn::scalar);
+    }
+
+    if (trimesh.has_per_vertex_restitution()) {
+        per_vertex += sizeof(edyn::scalar);
+    }
+
+    return sizeof(edyn::triangle_mesh) +
+           num_vertices * per_vertex +
+           num_edges * per_edge +
+           (num_edges * 2 + 7) / 8 + // Convex and boundary edge bits.
+           num_triangles * per_triangle +
+           num_triangles * 2 * per_tree_node;
+}
+
+void EnablePageCache(entt::registry &registry, entt::entity mesh_entity,
+                     std::shared_ptr<MappedPageLoader> loader,
+                     const PageCacheSettings &settings) {
+    auto &ctx = registry.ctx().emplace<PageCacheContext>();
+    ctx.mesh_entity = mesh_entity;
+    ctx.loader = std::move(loader);
+    ctx.settings = settings;
+    ctx.stats = {};
+    ctx.entries.assign(ctx.loader->numPages(), {});
+    ctx.last_update_time = edyn::performance_time();
+
+    // The vertex limit is derived from the budget from now on. It stays as
+    // is until the first page is in and the cost per vertex is known.
+    auto &shape = registry.get<edyn::paged_mesh_shape>(mesh_entity);
+    ctx.previous_max_cache_num_vertices = shape.trimesh->m_max_cache_num_vertices;
+}
+
+void DisablePageCache(entt::registry &registry) {
+    auto *ctx = registry.ctx().find<PageCacheContext>();
+
+    if (!ctx) {
+        return;
+    }
+
+    if (registry.valid(ctx->mesh_entity)) {
+        auto &shape = registry.get<edyn::paged_mesh_shape>(ctx->mesh_entity);
+        shape.trimesh->m_max_cache_num_vertices = ctx->previous_max_cache_num_vertices;
+    }
+
+    registry.ctx().erase<PageCacheContext>();
+}
+
+PageCacheSettings &GetPageCacheSettings(entt::registry &registry) {
+    return registry.ctx().get<PageCacheContext>().settings;
+}
+
+const PageCacheStats &GetPageCacheStats(entt::registry &registry) {
+    static const auto empty_stats = PageCacheStats{};
+    auto *ctx = registry.ctx().find<PageCacheContext>();
+    return ctx ? ctx->stats : empty_stats;
+}
+
+size_t GetPageCacheHeadroom(entt::registry &registry) {
+    auto *ctx = registry.ctx().find<PageCacheContext>();
+
+    if (!ctx) {
+        return std::numeric_limits<size_t>::max();
+    }
+
+    auto budget = ctx->settings.budget_bytes;
+    auto resident = ctx->stats.resident_bytes;
+    return resident < budget ? budget - resident : 0;
+}
+
+static void UpdateRate(double &rate, uint64_t count, double dt) {
+    // Exponential moving average with a time constant of one second.
+    if (dt > 0) {
+        rate += (count / dt - rate) * std::min(dt, 1.0);
+    }
+}
+
+void UpdatePageCache(entt::registry &registry) {
+    auto *ctx = registry.ctx().find<PageCacheContext>();
+
+    if (!ctx || !registry.valid(ctx->mesh_entity) || !ctx->loader->isOpen()) {
+        return;
+    }
+
+    auto &settings = ctx->settings;
+    auto &stats = ctx->stats;
+    auto &entries = ctx->entries;
+    auto &shape = registry.get<edyn::paged_mesh_shape>(ctx->mesh_entity);
+    auto time = edyn::performance_time();
+    auto dt = time - ctx->last_update_time;
+    ctx->last_update_time = time;
+
+    uint64_t num_loads = 0, num_thrash_reloads = 0, num_evictions = 0;
+    auto resident_vertices = size_t{0};
+    stats.resident_bytes = 0;
+    stats.resident_pages = 0;
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto &entry = entries[i];
+        auto trimesh = shape.trimesh->get_submesh(i);
+
+        if (trimesh && entry.bytes == 0) {
+            entry.bytes = GetTriangleMeshMemoryUsage(*trimesh);
+            entry.num_vertices = trimesh->num_vertices();
+            ++num_loads;
+
+            if (time - entry.eviction_time < settings.thrash_window) {
+                ++num_thrash_reloads;
+            }
+        } else if (!trimesh && entry.bytes != 0) {
+            entry.bytes = 0;
+            entry.num_vertices = 0;
+            entry.eviction_time = time;
+            ++num_evictions;
+        }
+
+        if (entry.bytes != 0) {
+            stats.resident_bytes += entry.bytes;
+            resident_vertices += entry.num_vertices;
+            ++stats.resident_pages;
+        }
+    }
+
+    // The paged mesh evicts its least recently used page whenever a load
+    // takes it over its vertex limit, thus the budget is enforced page by
+    // page by converting it into vertices at the measured cost per vertex.
+    if (resident_vertices > 0) {
+        auto bytes_per_vertex = std::max(stats.resident_bytes / resident_vertices, size_t{1});
+        shape.trimesh->m_max_cache_num_vertices = settings.budget_bytes / bytes_per_vertex;
+    }
+
+    stats.loads += num_loads;
+    stats.evictions += num_evictions;
+    stats.thrash_reloads += num_thrash_reloads;
+    UpdateRate(stats.load_rate, num_loads, dt);
+    UpdateRate(stats.eviction_rate, num_evictions, dt);
+    UpdateRate(stats.thrash_rate, num_thrash_reloads, dt);
+    stats.thrashing = stats.thrash_rate > settings.thrash_ratio * stats.load_rate && stats.thrash_rate > 0.1;
+}
@@ -0,0 +1,268 @@
+#include "page_codec.hpp"
+#include <array>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <edyn/serialization/paged_triangle_mesh_s11n.hpp>
+#include <edyn/shapes/triangle_mesh.hpp>
+
+static void WriteVarint(std::vector<uint8_t> &output, uint64_t value) {
+    while (value >= 0x80) {
+        output.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+
+    output.push_back(static_cast<uint8_t>(value));
+}
+
+static uint64_t ZigZag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t UnZigZag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Bit pattern of a scalar as an unsigned integer of the same size.
+template<typename T>
+using ScalarBits = std::conditional_t<sizeof(T) == sizeof(uint64_t), uint64_t, uint32_t>;
+
+// Number of low mantissa bits set to zero to keep `mantissa_bits`.
+template<typename T>
+static unsigned DroppedMantissaBits(unsigned mantissa_bits) {
+    constexpr unsigned stored_bits = std::numeric_limits<T>::digits - 1;
+    return mantissa_bits < stored_bits ? stored_bits - mantissa_bits : 0;
+}
+
+// Scalars are mostly vector components, which are closest to the same
+// component of the previous vector.
+static constexpr size_t page_scalar_stride = 3;
+
+struct PageReader {
+    const uint8_t *data;
+    const uint8_t *end;
+    bool valid {true};
+
+    uint64_t varint() {
+        uint64_t value = 0;
+
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            if (data == end) {
+                break;
+            }
+
+            auto byte = *data++;
+            value |= uint64_t(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+
+        valid = false;
+        return 0;
+    }
+};
+
+// Archive for `edyn::serialize` which splits values into integer, boolean
+// and scalar streams and codes each as described in `PageCodec::Quantized`.
+class PageOutputArchive {
+public:
+    using is_input = std::false_type;
+    using is_output = std::true_type;
+
+    PageOutputArchive(unsigned mantissa_bits)
+        : m_mantissa_bits(mantissa_bits)
+    {}
+
+    template<typename... Ts>
+    void operator()(Ts &... ts) {
+        (write(ts), ...);
+    }
+
+    void finish(std::vector<uint8_t> &output) const {
+        WriteVarint(output, m_mantissa_bits);
+        WriteVarint(output, m_integers.size());
+        WriteVarint(output, m_num_booleans);
+        WriteVarint(output, m_scalars.size());
+        output.insert(output.end(), m_integers.begin(), m_integers.end());
+        output.insert(output.end(), m_booleans.begin(), m_booleans.end());
+        output.insert(output.end(), m_scalars.begin(), m_scalars.end());
+    }
+
+private:
+    template<typename T>
+    void write(T &value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            writeBoolean(value);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            writeScalar(value);
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            writeInteger(static_cast<uint64_t>(value));
+        } else {
+            edyn::serialize(*this, value);
+        }
+    }
+
+    void writeBoolean(bool value) {
+        if (m_num_booleans % 8 == 0) {
+            m_booleans.push_back(0);
+        }
+
+        m_booleans.back() |= uint8_t(value) << (m_num_booleans % 8);
+        ++m_num_booleans;
+    }
+
+    void writeInteger(uint64_t value) {
+        WriteVarint(m_integers, ZigZag(static_cast<int64_t>(value - m_previous_integer)));
+        m_previous_integer = value;
+    }
+
+    template<typename T>
+    void writeScalar(T value) {
+        auto bits = ScalarBits<T>{};
+        std::memcpy(&bits, &value, sizeof(T));
+        auto dropped = DroppedMantissaBits<T>(m_mantissa_bits);
+        bits = bits >> dropped << dropped;
+
+        auto &previous = m_previous_scalars[m_num_scalars++ % page_scalar_stride];
+        WriteVarint(m_scalars, (uint64_t(bits) ^ previous) >> dropped);
+        previous = bits;
+    }
+
+    unsigned m_mantissa_bits;
+    std::vector<uint8_t> m_integers;
+    std::vector<uint8_t> m_booleans;
+    std::vector<uint8_t> m_scalars;
+    size_t m_num_booleans {};
+    size_t m_num_scalars {};
+    uint64_t m_previous_integer {};
+    std::array<uint64_t, page_scalar_stride> m_previous_scalars {};
+};
+
+class PageInputArchive {
+public:
+    using is_input = std::true_type;
+    using is_output = std::false_type;
+
+    PageInputArchive(const uint8_t *data, size_t size) {
+        auto header = PageReader{data, data + size};
+        m_mantissa_bits = static_cast<unsigned>(header.varint());
+        auto integers_size = header.varint();
+        m_num_booleans = header.varint();
+        auto scalars_size = header.varint();
+        auto booleans_size = (m_num_booleans + 7) / 8;
+        auto remaining = static_cast<uint64_t>(header.end - header.data);
+
+        if (!header.valid || integers_size > remaining || booleans_size > remaining - integers_size ||
+            scalars_size != remaining - integers_size - booleans_size) {
+            m_valid = false;
+            return;
+        }
+
+        m_integers = {header.data, header.data + integers_size};
+        m_booleans = header.data + integers_size;
+        m_scalars = {m_booleans + booleans_size, header.end};
+    }
+
+    template<typename... Ts>
+    void operator()(Ts &... ts) {
+        (read(ts), ...);
+    }
+
+    // Whether all data was valid and all of it was read.
+    bool valid() const {
+        return m_valid && m_integers.valid && m_scalars.valid &&
+               m_integers.data == m_integers.end && m_scalars.data == m_scalars.end &&
+               m_boolean_index == m_num_booleans;
+    }
+
+private:
+    template<typename T>
+    void read(T &value) {
+        if constexpr (std::is_same_v<T, bool>) {
+            value = readBoolean();
+        } else if constexpr (std::is_floating_point_v<T>) {
+            value = readScalar<T>();
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            value = static_cast<T>(readInteger());
+        } else {
+            edyn::serialize(*this, value);
+        }
+    }
+
+    bool readBoolean() {
+        if (!m_valid || m_boolean_index == m_num_booleans) {
+            m_valid = false;
+            return false;
+        }
+
+        auto value = (m_booleans[m_boolean_index / 8] >> (m_boolean_index % 8)) & 1;
+        ++m_boolean_index;
+        return value != 0;
+    }
+
+    uint64_t readInteger() {
+        if (!m_valid) {
+            return 0;
+        }
+
+        auto delta = UnZigZag(m_integers.varint());
+
+        // Stop before a bogus size is used to allocate.
+        if (!m_integers.valid) {
+            m_valid = false;
+            return 0;
+        }
+
+        m_previous_integer += static_cast<uint64_t>(delta);
+        return m_previous_integer;
+    }
+
+    template<typename T>
+    T readScalar() {
+        if (!m_valid) {
+            return T{};
+        }
+
+        auto dropped = DroppedMantissaBits<T>(m_mantissa_bits);
+        auto delta = m_scalars.varint();
+
+        if (!m_scalars.valid) {
+            m_valid = false;
+            return T{};
+        }
+
+        auto &previous = m_previous_scalars[m_num_scalars++ % page_scalar_stride];
+        previous ^= delta << dropped;
+
+        auto bits = static_cast<ScalarBits<T>>(previous);
+        auto value = T{};
+        std::memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+
+    bool m_valid {true};
+    unsigned m_mantissa_bits {};
+    PageReader m_integers {nullptr, nullptr};
+    const uint8_t *m_booleans {nullptr};
+    uint64_t m_num_booleans {};
+    uint64_t m_boolean_index {};
+    PageReader m_scalars {nullptr, nullptr};
+    size_t m_num_scalars {};
+    uint64_t m_previous_integer {};
+    std::array<uint64_t, page_scalar_stride> m_previous_scalars {};
+};
+
+void EncodePage(edyn::triangle_mesh &trimesh, const PageCodecSettings &settings,
+                std::vector<uint8_t> &output) {
+    auto archive = PageOutputArchive(settings.mantissa_bits);
+    edyn::serialize(archive, trimesh);
+    archive.finish(output);
+}
+
+bool DecodePage(const uint8_t *data, size_t size, edyn::triangle_mesh &trimesh) {
+    auto archive = PageInputArchive(data, size);
+    edyn::serialize(archive, trimesh);
+    return archive.valid();
+}
@@ -0,0 +1,204 @@
+#include "page_prefetch.hpp"
+#include "mapped_page_loader.hpp"
+#include "page_cache.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <vector>
+#include <edyn/edyn.hpp>
+
+struct PagePrefetchContext {
+    entt::entity mesh_entity;
+    std::shared_ptr<MappedPageLoader> loader;
+    PagePrefetchSettings settings;
+    PagePrefetchStats stats;
+    // Pages that were prefetched and haven't been reached by any body yet.
+    std::vector<bool> prefetched;
+    // Soonest time of contact with each page in the current update.
+    std::vector<edyn::scalar> time_of_contact;
+};
+
+void EnablePagePrefetch(entt::registry &registry, entt::entity mesh_entity,
+                        std::shared_ptr<MappedPageLoader> loader,
+                        const PagePrefetchSettings &settings) {
+    auto &ctx = registry.ctx().emplace<PagePrefetchContext>();
+    ctx.mesh_entity = mesh_entity;
+    ctx.loader = std::move(loader);
+    ctx.settings = settings;
+    ctx.stats = {};
+    ctx.prefetched.assign(ctx.loader->numPages(), false);
+}
+
+void DisablePagePrefetch(entt::registry &registry) {
+    registry.ctx().erase<PagePrefetchContext>();
+}
+
+PagePrefetchSettings &GetPagePrefetchSettings(entt::registry &registry) {
+    return registry.ctx().get<PagePrefetchContext>().settings;
+}
+
+PagePrefetchStats GetPagePrefetchStats(entt::registry &registry) {
+    auto *ctx = registry.ctx().find<PagePrefetchContext>();
+
+    if (!ctx) {
+        return {};
+    }
+
+    auto stats = ctx->stats;
+    stats.misses = ctx->loader->numMisses();
+    stats.late_loads = ctx->loader->numLateLoads();
+    return stats;
+}
+
+static edyn::AABB ToObjectSpace(const edyn::AABB &aabb, const edyn::vector3 &pos, const edyn::quaternion &orn) {
+    auto result = edyn::AABB{edyn::vector3_max, -edyn::vector3_max};
+
+    for (int i = 0; i < 8; ++i) {
+        auto corner = edyn::vector3{
+            i & 1 ? aabb.max.x : aabb.min.x,
+            i & 2 ? aabb.max.y : aabb.min.y,
+            i & 4 ? aabb.max.z : aabb.min.z
+        };
+        auto local = edyn::to_object_space(corner, pos, orn);
+        result.min = edyn::min(result.min, local);
+        result.max = edyn::max(result.max, local);
+    }
+
+    return result;
+}
+
+// Time at which `aabb` moving with `velocity` starts to overlap `target`, or
+// a negative value if it doesn't within `max_time`. Zero if already
+// overlapping. Done as a ray cast from the center of `aabb` against `target`
+// inflated by its half extents.
+static edyn::scalar TimeOfContact(const edyn::AABB &aabb, const edyn::vector3 &velocity,
+                                  const edyn::AABB &target, edyn::scalar max_time) {
+    auto center = (aabb.min + aabb.max) / 2;
+    auto half_extents = (aabb.max - aabb.min) / 2;
+    auto min = target.min - half_extents;
+    auto max = target.max + half_extents;
+    auto t_enter = edyn::scalar(0);
+    auto t_exit = max_time;
+
+    for (int i = 0; i < 3; ++i) {
+        if (std::abs(velocity[i]) <= EDYN_EPSILON) {
+            if (center[i] < min[i] || center[i] > max[i]) {
+                return -1;
+            }
+            continue;
+        }
+
+        auto t0 = (min[i] - center[i]) / velocity[i];
+        auto t1 = (max[i] - center[i]) / velocity[i];
+
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+
+        t_enter = std::max(t_enter, t0);
+        t_exit = std::min(t_exit, t1);
+
+        if (t_enter > t_exit) {
+            return -1;
+        }
+    }
+
+    return t_enter;
+}
+
+void UpdatePagePrefetch(entt::registry &registry) {
+    auto *ctx = registry.ctx().find<PagePrefetchContext>();
+
+    if (!ctx || !registry.valid(ctx->mesh_entity) || !ctx->loader->isOpen()) {
+        return;
+    }
+
+    auto &loader = *ctx->loader;
+    auto &settings = ctx->settings;
+    auto &shape = registry.get<edyn::paged_mesh_shape>(ctx->mesh_entity);
+    auto &mesh_pos = registry.get<edyn::position>(ctx->mesh_entity);
+    auto &mesh_orn = registry.get<edyn::orientation>(ctx->mesh_entity);
+    auto num_pages = loader.numPages();
+    auto min_speed_sqr = settings.min_speed * settings.min_speed;
+
+    ctx->prefetched.resize(num_pages, false);
+    ctx->time_of_contact.assign(num_pages, -1);
+
+    auto page_aabbs = std::vector<edyn::AABB>(num_pages);
+
+    for (size_t i = 0; i < num_pages; ++i) {
+        page_aabbs[i] = loader.pageAABB(i);
+    }
+
+    // Sweep bodies in the object space of the mesh, where the page bounds are.
+    auto body_view = registry.view<edyn::AABB, edyn::linvel, edyn::dynamic_tag>();
+
+    for (auto [entity, aabb, linvel] : body_view.each()) {
+        // Slow bodies are still checked for overlaps to count hits.
+        auto local_aabb = ToObjectSpace(aabb, mesh_pos, mesh_orn);
+        auto local_vel = edyn::rotate(edyn::conjugate(mesh_orn), linvel);
+        auto horizon = edyn::length_sqr(linvel) < min_speed_sqr ? edyn::scalar(0) : settings.horizon;
+        auto swept_aabb = local_aabb;
+        swept_aabb.min = edyn::min(swept_aabb.min, swept_aabb.min + local_vel * horizon);
+        swept_aabb.max = edyn::max(swept_aabb.max, swept_aabb.max + local_vel * horizon);
+
+        for (size_t i = 0; i < num_pages; ++i) {
+            if (!edyn::intersect(swept_aabb, page_aabbs[i])) {
+                continue;
+            }
+
+            auto toc = TimeOfContact(local_aabb, local_vel, page_aabbs[i], horizon);
+            auto &best = ctx->time_of_contact[i];
+
+            if (toc >= 0 && (best < 0 || toc < best)) {
+                best = toc;
+            }
+        }
+    }
+
+    using queue_entry = std::pair<edyn::scalar, size_t>;
+    auto queue = std::priority_queue<queue_entry, std::vector<queue_entry>, std::greater<queue_entry>>{};
+
+    for (size_t i = 0; i < num_pages; ++i) {
+        auto is_cached = shape.trimesh->get_submesh(i) != nullptr;
+        auto toc = ctx->time_of_contact[i];
+
+        if (ctx->prefetched[i]) {
+            if (is_cached && toc == 0) {
+                // A body has reached a page that was loaded ahead of time.
+                ++ctx->stats.hits;
+                ctx->prefetched[i] = false;
+            } else if (!is_cached && !loader.isLoading(i)) {
+                // Evicted before any body reached it.
+                ctx->prefetched[i] = false;
+            }
+        }
+
+        // Pages already overlapped are loaded by the paged mesh itself.
+        if (toc > 0 && !is_cached) {
+            queue.emplace(toc, i);
+        }
+    }
+
+    // Don't let prefetching push the page cache over budget, which would
+    // cause pages in use to be evicted. The stored size is a lower bound for
+    // encoded pages, the page cache takes care of the difference.
+    auto headroom = GetPageCacheHeadroom(registry);
+
+    for (unsigned count = 0; !queue.empty() && count < settings.max_loads_per_update; queue.pop()) {
+        auto index = queue.top().second;
+        auto page_size = loader.entry(index).size;
+
+        if (page_size > headroom) {
+            break;
+        }
+
+        if (loader.prefetch(index)) {
+            headroom -= page_size;
+            ctx->prefetched[index] = true;
+            ++ctx->stats.prefetches;
+            ++count;
+        }
+    }
+}
@@ -0,0 +1,214 @@
+#include "raycast_vehicle_system.hpp"
+#include "vehicle_system.hpp"
+#include <edyn/comp/tag.hpp>
+#include <edyn/networking/comp/asset_ref.hpp>
+#include <edyn/networking/util/asset_util.hpp>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+void MakeRaycastVehicle(entt::registry &registry, entt::entity vehicle_entity, entt::entity chassis_entity) {
+    auto &settings = registry.get_or_emplace<RaycastVehicleSettings>(vehicle_entity);
+
+    auto vehicle = RaycastVehicle{};
+    vehicle.chassis_entity = chassis_entity;
+    vehicle.suspension_length.fill(settings.rest_length);
+    registry.emplace<RaycastVehicle>(vehicle_entity, vehicle);
+}
+
+entt::entity CreateRaycastVehicle(entt::registry &registry, edyn::vector3 position) {
+    auto chassis_def = edyn::rigidbody_def();
+    chassis_def.material->restitution = 0.3;
+    chassis_def.material->friction = 0.3;
+    // Include the mass of the wheels, which are not simulated as bodies.
+    chassis_def.mass = 800;
+    chassis_def.shape = edyn::box_shape{0.65, 0.5, 1.85};
+    chassis_def.position = position;
+    auto chassis_entity = edyn::make_rigidbody(registry, chassis_def);
+
+    registry.emplace<VehicleSettings>(chassis_entity);
+    registry.emplace<VehicleState>(chassis_entity);
+    registry.emplace<edyn::action_history>(chassis_entity);
+    registry.emplace<VehicleActionList>(chassis_entity);
+    MakeRaycastVehicle(registry, chassis_entity, chassis_entity);
+
+    return chassis_entity;
+}
+
+entt::entity MakeRaycastVehicleNetworked(entt::registry &registry, entt::entity vehicle_entity) {
+    auto asset_entity = registry.create();
+    registry.emplace<edyn::asset_ref>(asset_entity, RaycastVehicleAssetID);
+
+    auto &vehicle = registry.get<RaycastVehicle>(vehicle_entity);
+    EDYN_ASSERT(vehicle.chassis_entity == vehicle_entity);
+
+    edyn::assign_to_asset<
+        VehicleState, RaycastVehicle,
+        edyn::position, edyn::orientation,
+        edyn::linvel, edyn::angvel>(registry, vehicle_entity, asset_entity,
+                                    static_cast<unsigned>(RaycastVehicleAssetEntry::Vehicle));
+
+    return asset_entity;
+}
+
+static void UpdateRaycastVehicle(entt::registry &registry, RaycastVehicle &vehicle,
+                                 const RaycastVehicleSettings &rc_settings,
+                                 const VehicleSettings &settings, const VehicleState &state,
+                                 edyn::scalar dt) {
+    auto chassis = vehicle.chassis_entity;
+    auto &pos = registry.get<edyn::position>(chassis);
+    auto &orn = registry.get<edyn::orientation>(chassis);
+    auto &linvel = registry.get<edyn::linvel>(chassis);
+    auto &angvel = registry.get<edyn::angvel>(chassis);
+    auto chassis_mass = registry.get<edyn::mass>(chassis).s;
+
+    auto vel_view = registry.view<edyn::linvel, edyn::angvel>();
+    auto dyn_view = registry.view<edyn::dynamic_tag>();
+    auto up = edyn::quaternion_y(orn);
+    auto ray_length = rc_settings.max_length + rc_settings.wheel_radius;
+
+    struct WheelContact {
+        edyn::vector3 point;
+        edyn::vector3 normal;
+        entt::entity entity;
+        edyn::scalar normal_force;
+    };
+
+    std::array<WheelContact, 4> contacts;
+    int num_grounded = 0;
+
+    // Suspension.
+    for (int i = 0; i < 4; ++i) {
+        auto p0 = edyn::to_world_space(rc_settings.mount_position[i], pos, orn);
+        auto p1 = p0 - up * ray_length;
+        auto res = edyn::raycast(registry, p0, p1, {chassis});
+        auto prev_length = vehicle.suspension_length[i];
+        vehicle.grounded[i] = res.entity != entt::null;
+
+        if (!vehicle.grounded[i]) {
+            vehicle.suspension_length[i] = rc_settings.max_length;
+            contacts[i].normal_force = 0;
+            continue;
+        }
+
+        ++num_grounded;
+
+        auto length = std::clamp(res.fraction * ray_length - rc_settings.wheel_radius,
+                                 edyn::scalar(0), rc_settings.max_length);
+        vehicle.suspension_length[i] = length;
+
+        auto spring_force = (rc_settings.rest_length - length) * rc_settings.spring_stiffness;
+
+        if (length < rc_settings.bump_stop_length) {
+            spring_force += (rc_settings.bump_stop_length - length) * rc_settings.bump_stop_stiffness;
+        }
+
+        auto damping_force = (prev_length - length) / dt * rc_settings.damping;
+        auto normal_force = std::max(spring_force + damping_force, edyn::scalar(0));
+
+        contacts[i] = {edyn::lerp(p0, p1, res.fraction), res.normal, res.entity, normal_force};
+    }
+
+    // Tyres.
+    for (int i = 0; i < 4; ++i) {
+        auto steering = GetWheelSteering(state, i);
+        auto wheel_forward = edyn::rotate(orn * edyn::quaternion_axis_angle({0, 1, 0}, steering), edyn::vector3{0, 0, 1});
+
+        if (!vehicle.grounded[i]) {
+            // Spin freely, driven by the engine and slowed down by brakes and
+            // bearing friction.
+            auto &spin_speed = vehicle.spin_speed[i];
+            spin_speed += state.throttle * settings.driving_torque / rc_settings.wheel_inertia * dt;
+            auto friction_delta = (state.brakes * settings.brake_torque + settings.bearing_torque) /
+                                  rc_settings.wheel_inertia * dt;
+            spin_speed = std::copysign(std::max(std::abs(spin_speed) - friction_delta, edyn::scalar(0)), spin_speed);
+            vehicle.spin_angle[i] += spin_speed * dt;
+            continue;
+        }
+
+        auto &contact = contacts[i];
+        auto normal = contact.normal;
+        auto forward = edyn::normalize(edyn::project_direction(wheel_forward, normal));
+        auto side = edyn::cross(normal, forward);
+
+        auto r = contact.point - pos;
+        auto velocity = linvel + edyn::cross(angvel, r);
+
+        if (vel_view.contains(contact.entity)) {
+            auto pos_other = registry.get<edyn::position>(contact.entity);
+            velocity -= vel_view.get<edyn::linvel>(contact.entity) +
+                        edyn::cross(vel_view.get<edyn::angvel>(contact.entity), contact.point - pos_other);
+        }
+
+        auto longitudinal_speed = edyn::dot(velocity, forward);
+        auto lateral_speed = edyn::dot(velocity, side);
+        auto max_friction = contact.normal_force * rc_settings.tyre_friction;
+
+        // The wheel is assumed to roll without slipping thus the traction is
+        // only limited by the friction circle below.
+        auto longitudinal_force = state.throttle * settings.driving_torque / rc_settings.wheel_radius;
+
+        // Brakes oppose the longitudinal motion but never reverse it within
+        // one step. This also acts as an ABS since the wheel never locks.
+        auto brake_force = (state.brakes * settings.brake_torque + settings.bearing_torque) / rc_settings.wheel_radius;
+        auto max_brake_force = std::abs(longitudinal_speed) * chassis_mass / (num_grounded * dt);
+        longitudinal_force -= std::min(brake_force, max_brake_force) * edyn::scalar(longitudinal_speed > 0 ? 1 : -1);
+
+        // Lateral force that cancels the sideways velocity of the contact
+        // point, with the chassis mass spread over the grounded wheels.
+        auto lateral_force = -lateral_speed * chassis_mass / (num_grounded * dt);
+
+        // Friction circle.
+        auto friction_sqr = longitudinal_force * longitudinal_force + lateral_force * lateral_force;
+
+        if (friction_sqr > max_friction * max_friction) {
+            auto scale = max_friction / std::sqrt(friction_sqr);
+            longitudinal_force *= scale;
+            lateral_force *= scale;
+        }
+
+        auto impulse = (up * contact.normal_force + forward * longitudinal_force + side * lateral_force) * dt;
+        edyn::rigidbody_apply_impulse(registry, chassis, impulse, r);
+
+        if (dyn_view.contains(contact.entity)) {
+            auto pos_other = registry.get<edyn::position>(contact.entity);
+            edyn::rigidbody_apply_impulse(registry, contact.entity, -impulse, contact.point - pos_other);
+        }
+
+        // Assume rolling without slipping for the visual wheel spin.
+        vehicle.spin_speed[i] = longitudinal_speed / rc_settings.wheel_radius;
+        vehicle.spin_angle[i] += vehicle.spin_speed[i] * dt;
+    }
+}
+
+void UpdateRaycastVehicles(entt::registry &registry) {
+    auto dt = edyn::get_fixed_dt(registry);
+    auto vehicle_view = registry.view<RaycastVehicle, const RaycastVehicleSettings,
+                                      const VehicleSettings, VehicleState>(edyn::exclude_sleeping_disabled);
+
+    for (auto [entity, vehicle, rc_settings, settings, state] : vehicle_view.each()) {
+        AdvanceSteering(settings, state, dt);
+        UpdateRaycastVehicle(registry, vehicle, rc_settings, settings, state, dt);
+        registry.patch<VehicleState>(entity);
+        registry.patch<RaycastVehicle>(entity);
+    }
+}
+
+std::vector<entt::entity> GetRaycastVehicleEntities(entt::registry &registry, entt::entity vehicle_entity) {
+    std::vector<entt::entity> entities;
+    entities.push_back(vehicle_entity);
+
+    auto &vehicle = registry.get<RaycastVehicle>(vehicle_entity);
+
+    if (vehicle.chassis_entity != vehicle_entity) {
+        entities.push_back(vehicle.chassis_entity);
+    }
+
+    return entities;
+}
+
+std::map<entt::id_type, entt::entity>
+CreateRaycastVehicleAssetEntityMap(entt::registry &registry, entt::entity vehicleEntity) {
+    auto emap = std::map<entt::id_type, entt::entity>{};
+    emap[static_cast<unsigned>(RaycastVehicleAssetEntry::Vehicle)] = vehicleEntity;
+    return emap;
+}
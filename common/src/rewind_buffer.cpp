@@ -0,0 +1,533 @@
+#include "rewind_buffer.hpp"
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <edyn/collision/contact_manifold.hpp>
+#include <edyn/edyn.hpp>
+
+// Position, orientation, linear and angular velocity.
+static constexpr size_t rewind_values_per_body = 13;
+// Point, normal and normal impulse.
+static constexpr size_t rewind_values_per_contact = 7;
+
+struct RewindFrame {
+    // Simulation time, advanced by a fixed step per recorded frame, thus
+    // the window doesn't move while paused. Starts at zero.
+    double time;
+    bool keyframe;
+    std::vector<uint8_t> data;
+};
+
+// Decoded state of one frame.
+struct RewindState {
+    std::vector<entt::entity> entities;
+    std::vector<int64_t> values;
+    std::vector<std::array<entt::entity, 2>> contact_bodies;
+    std::vector<int64_t> contact_values;
+};
+
+struct RewindContext {
+    RewindSettings settings;
+    std::deque<RewindFrame> frames;
+    // Buffers of frames that went out of the window, reused for new frames.
+    std::vector<std::vector<uint8_t>> pool;
+    size_t cursor {};
+    unsigned frames_since_keyframe {};
+    bool force_keyframe {true};
+    // State of the latest frame, which the next one is encoded against.
+    RewindState last;
+    RewindState current;
+    // State of the frame at the cursor and its index, which allows stepping
+    // forward without decoding from the keyframe.
+    RewindState decoded;
+    size_t decoded_index {std::numeric_limits<size_t>::max()};
+    std::vector<RewindContact> contacts;
+    std::vector<RewindContact> no_contacts;
+};
+
+struct RewindReplayHeader {
+    static constexpr uint32_t current_version = 2;
+
+    char magic[4] {'E', 'D', 'R', 'W'};
+    uint32_t version {current_version};
+    float position_step;
+    float orientation_step;
+    float velocity_step;
+    float impulse_step;
+    uint32_t num_frames;
+    // Followed by `num_frames` frames, each a `RewindReplayFrame` followed by
+    // its data. The first frame is a keyframe.
+};
+
+struct RewindReplayFrame {
+    double time;
+    uint32_t keyframe;
+    uint32_t size;
+};
+
+static void WriteVarint(std::vector<uint8_t> &output, uint64_t value) {
+    while (value >= 0x80) {
+        output.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    output.push_back(static_cast<uint8_t>(value));
+}
+
+static uint64_t ReadVarint(const uint8_t *&p) {
+    uint64_t value = 0;
+
+    for (unsigned shift = 0;; shift += 7) {
+        auto byte = *p++;
+        value |= uint64_t(byte & 0x7f) << shift;
+
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+}
+
+static uint64_t ZigZag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+static int64_t UnZigZag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+static int64_t Quantize(edyn::scalar value, edyn::scalar step) {
+    return static_cast<int64_t>(std::llround(value / step));
+}
+
+static edyn::scalar Dequantize(int64_t value, edyn::scalar step) {
+    return static_cast<edyn::scalar>(value) * step;
+}
+
+static void CaptureState(entt::registry &registry, const RewindSettings &settings, RewindState &state) {
+    auto view = registry.view<edyn::position, edyn::orientation, edyn::linvel, edyn::angvel>();
+    state.entities.clear();
+    state.values.clear();
+    state.contact_bodies.clear();
+    state.contact_values.clear();
+
+    for (auto [entity, pos, orn, linvel, angvel] : view.each()) {
+        state.entities.push_back(entity);
+
+        for (int i = 0; i < 3; ++i) {
+            state.values.push_back(Quantize(pos[i], settings.position_step));
+        }
+
+        for (int i = 0; i < 4; ++i) {
+            state.values.push_back(Quantize(orn[i], settings.orientation_step));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            state.values.push_back(Quantize(linvel[i], settings.velocity_step));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            state.values.push_back(Quantize(angvel[i], settings.velocity_step));
+        }
+    }
+
+    if (!settings.record_contacts) {
+        return;
+    }
+
+    auto cp_view = registry.view<edyn::contact_point, edyn::contact_point_list, edyn::contact_point_impulse>();
+    auto manifold_view = registry.view<edyn::contact_manifold>();
+
+    for (auto [entity, cp, cp_list, cp_imp] : cp_view.each()) {
+        if (!manifold_view.contains(cp_list.parent)) {
+            continue;
+        }
+
+        auto &manifold = manifold_view.get<edyn::contact_manifold>(cp_list.parent);
+        auto posB = edyn::get_rigidbody_origin(registry, manifold.body[1]);
+        auto &ornB = registry.get<edyn::orientation>(manifold.body[1]);
+
+        auto point = edyn::to_world_space(cp.pivotB, posB, ornB);
+        auto normal_impulse = cp_imp.normal_impulse + cp_imp.normal_restitution_impulse;
+        state.contact_bodies.push_back(manifold.body);
+
+        for (int i = 0; i < 3; ++i) {
+            state.contact_values.push_back(Quantize(point[i], settings.position_step));
+        }
+
+        for (int i = 0; i < 3; ++i) {
+            state.contact_values.push_back(Quantize(cp.normal[i], settings.orientation_step));
+        }
+
+        state.contact_values.push_back(Quantize(normal_impulse, settings.impulse_step));
+    }
+}
+
+// Writes a bit mask of the values of each item that changed followed by their
+// deltas. Without previous values, all non-zero values are written as is.
+static void EncodeValues(const int64_t *values, const int64_t *prev_values, size_t num_items,
+                         size_t values_per_item, std::vector<uint8_t> &output) {
+    for (size_t i = 0; i < num_items * values_per_item; i += values_per_item) {
+        uint32_t mask = 0;
+
+        for (size_t j = 0; j < values_per_item; ++j) {
+            auto base = prev_values ? prev_values[i + j] : 0;
+            mask |= uint32_t(values[i + j] != base) << j;
+        }
+
+        WriteVarint(output, mask);
+
+        for (size_t j = 0; j < values_per_item; ++j) {
+            if (mask & (1u << j)) {
+                auto base = prev_values ? prev_values[i + j] : 0;
+                WriteVarint(output, ZigZag(values[i + j] - base));
+            }
+        }
+    }
+}
+
+static void DecodeValues(const uint8_t *&p, size_t num_items, size_t values_per_item, int64_t *values) {
+    for (size_t i = 0; i < num_items * values_per_item; i += values_per_item) {
+        auto mask = static_cast<uint32_t>(ReadVarint(p));
+
+        for (size_t j = 0; j < values_per_item; ++j) {
+            if (mask & (1u << j)) {
+                values[i + j] += UnZigZag(ReadVarint(p));
+            }
+        }
+    }
+}
+
+// Encodes `state` against `prev`, or by itself for keyframes. Contacts are
+// delta encoded like bodies while the set of contacts stays the same.
+static void EncodeState(const RewindState &state, const RewindState &prev, bool keyframe,
+                        std::vector<uint8_t> &output) {
+    auto num_bodies = state.entities.size();
+    auto same_entities = !keyframe && state.entities == prev.entities;
+
+    WriteVarint(output, num_bodies);
+    output.push_back(same_entities ? 0 : 1);
+
+    if (!same_entities) {
+        for (auto entity : state.entities) {
+            WriteVarint(output, entt::to_integral(entity));
+        }
+    }
+
+    EncodeValues(state.values.data(), same_entities ? prev.values.data() : nullptr,
+                 num_bodies, rewind_values_per_body, output);
+
+    auto num_contacts = state.contact_bodies.size();
+    auto same_contacts = !keyframe && state.contact_bodies == prev.contact_bodies;
+
+    WriteVarint(output, num_contacts);
+    output.push_back(same_contacts ? 0 : 1);
+
+    if (!same_contacts) {
+        for (auto &body : state.contact_bodies) {
+            WriteVarint(output, entt::to_integral(body[0]));
+            WriteVarint(output, entt::to_integral(body[1]));
+        }
+    }
+
+    EncodeValues(state.contact_values.data(), same_contacts ? prev.contact_values.data() : nullptr,
+                 num_contacts, rewind_values_per_contact, output);
+}
+
+// Decodes a frame into `state`, which must hold the state of the previous
+// frame unless it's a keyframe.
+static void DecodeState(const std::vector<uint8_t> &data, RewindState &state) {
+    auto *p = data.data();
+    auto num_bodies = static_cast<size_t>(ReadVarint(p));
+    auto same_entities = *p++ == 0;
+
+    if (!same_entities) {
+        state.entities.resize(num_bodies);
+
+        for (auto &entity : state.entities) {
+            entity = entt::entity{static_cast<entt::id_type>(ReadVarint(p))};
+        }
+
+        state.values.assign(num_bodies * rewind_values_per_body, 0);
+    }
+
+    DecodeValues(p, num_bodies, rewind_values_per_body, state.values.data());
+
+    auto num_contacts = static_cast<size_t>(ReadVarint(p));
+    auto same_contacts = *p++ == 0;
+
+    if (!same_contacts) {
+        state.contact_bodies.resize(num_contacts);
+
+        for (auto &body : state.contact_bodies) {
+            body[0] = entt::entity{static_cast<entt::id_type>(ReadVarint(p))};
+            body[1] = entt::entity{static_cast<entt::id_type>(ReadVarint(p))};
+        }
+
+        state.contact_values.assign(num_contacts * rewind_values_per_contact, 0);
+    }
+
+    DecodeValues(p, num_contacts, rewind_values_per_contact, state.contact_values.data());
+}
+
+static void DequantizeContacts(const RewindSettings &settings, const RewindState &state,
+                               std::vector<RewindContact> &contacts) {
+    contacts.resize(state.contact_bodies.size());
+
+    for (size_t i = 0; i < contacts.size(); ++i) {
+        auto *values = &state.contact_values[i * rewind_values_per_contact];
+        auto &contact = contacts[i];
+        contact.body = state.contact_bodies[i];
+
+        for (int j = 0; j < 3; ++j) {
+            contact.point[j] = Dequantize(values[j], settings.position_step);
+            contact.normal[j] = Dequantize(values[3 + j], settings.orientation_step);
+        }
+
+        contact.normal_impulse = Dequantize(values[6], settings.impulse_step);
+    }
+}
+
+static void ApplyState(entt::registry &registry, const RewindSettings &settings, const RewindState &state) {
+    auto view = registry.view<edyn::position, edyn::orientation>();
+    auto vel_view = registry.view<edyn::linvel, edyn::angvel>();
+
+    for (size_t i = 0; i < state.entities.size(); ++i) {
+        auto entity = state.entities[i];
+
+        if (!registry.valid(entity) || !view.contains(entity)) {
+            continue;
+        }
+
+        auto *values = &state.values[i * rewind_values_per_body];
+        auto pos = edyn::vector3{};
+        auto orn = edyn::quaternion{};
+        auto linvel = edyn::vector3{};
+        auto angvel = edyn::vector3{};
+
+        for (int j = 0; j < 3; ++j) {
+            pos[j] = Dequantize(values[j], settings.position_step);
+            linvel[j] = Dequantize(values[7 + j], settings.velocity_step);
+            angvel[j] = Dequantize(values[10 + j], settings.velocity_step);
+        }
+
+        for (int j = 0; j < 4; ++j) {
+            orn[j] = Dequantize(values[3 + j], settings.orientation_step);
+        }
+
+        orn = edyn::normalize(orn);
+
+        // Replacing notifies Edyn of the changes, which are then propagated
+        // to the simulation.
+        registry.replace<edyn::position>(entity, pos);
+        registry.replace<edyn::orientation>(entity, orn);
+
+        if (vel_view.contains(entity)) {
+            registry.replace<edyn::linvel>(entity, linvel);
+            registry.replace<edyn::angvel>(entity, angvel);
+        }
+
+        // The presentation isn't updated while paused.
+        if (registry.all_of<edyn::present_position, edyn::present_orientation>(entity)) {
+            registry.replace<edyn::present_position>(entity, pos);
+            registry.replace<edyn::present_orientation>(entity, orn);
+        }
+    }
+}
+
+static std::vector<uint8_t> AcquireBuffer(RewindContext &ctx) {
+    if (ctx.pool.empty()) {
+        return {};
+    }
+
+    auto buffer = std::move(ctx.pool.back());
+    ctx.pool.pop_back();
+    buffer.clear();
+    return buffer;
+}
+
+static void ReleaseFrame(RewindContext &ctx, RewindFrame &frame) {
+    ctx.pool.push_back(std::move(frame.data));
+}
+
+void EnableRewind(entt::registry &registry, const RewindSettings &settings) {
+    auto &ctx = registry.ctx().emplace<RewindContext>();
+    ctx.settings = settings;
+}
+
+void DisableRewind(entt::registry &registry) {
+    registry.ctx().erase<RewindContext>();
+}
+
+RewindSettings &GetRewindSettings(entt::registry &registry) {
+    return registry.ctx().get<RewindContext>().settings;
+}
+
+void RecordRewindFrame(entt::registry &registry) {
+    auto *ctx = registry.ctx().find<RewindContext>();
+
+    if (ctx == nullptr) {
+        return;
+    }
+
+    // Branch off from the current frame.
+    while (!ctx->frames.empty() && ctx->cursor + 1 < ctx->frames.size()) {
+        ReleaseFrame(*ctx, ctx->frames.back());
+        ctx->frames.pop_back();
+        ctx->force_keyframe = true;
+    }
+
+    CaptureState(registry, ctx->settings, ctx->current);
+
+    auto keyframe = ctx->force_keyframe || ctx->frames_since_keyframe + 1 >= ctx->settings.keyframe_interval;
+    auto time = ctx->frames.empty() ? 0.0 : ctx->frames.back().time + edyn::get_fixed_dt(registry);
+    auto &frame = ctx->frames.emplace_back();
+    frame.time = time;
+    frame.keyframe = keyframe;
+    frame.data = AcquireBuffer(*ctx);
+    EncodeState(ctx->current, ctx->last, keyframe, frame.data);
+
+    std::swap(ctx->last, ctx->current);
+    ctx->frames_since_keyframe = keyframe ? 0 : ctx->frames_since_keyframe + 1;
+    ctx->force_keyframe = false;
+    ctx->decoded_index = std::numeric_limits<size_t>::max();
+
+    // Drop frames out of the window. Frames before the first keyframe can't
+    // be decoded anymore thus the window always starts at a keyframe.
+    while (ctx->frames.size() > 1 &&
+           (time - ctx->frames.front().time > ctx->settings.duration || !ctx->frames.front().keyframe)) {
+        ReleaseFrame(*ctx, ctx->frames.front());
+        ctx->frames.pop_front();
+    }
+
+    ctx->cursor = ctx->frames.size() - 1;
+}
+
+void ClearRewind(entt::registry &registry) {
+    auto *ctx = registry.ctx().find<RewindContext>();
+
+    if (ctx == nullptr) {
+        return;
+    }
+
+    for (auto &frame : ctx->frames) {
+        ReleaseFrame(*ctx, frame);
+    }
+
+    ctx->frames.clear();
+    ctx->cursor = 0;
+    ctx->frames_since_keyframe = 0;
+    ctx->force_keyframe = true;
+    ctx->decoded_index = std::numeric_limits<size_t>::max();
+}
+
+bool SeekRewind(entt::registry &registry, int offset) {
+    auto *ctx = registry.ctx().find<RewindContext>();
+
+    if (ctx == nullptr || ctx->frames.empty()) {
+        return false;
+    }
+
+    auto target = static_cast<int64_t>(ctx->cursor) + offset;
+
+    if (target < 0 || target >= static_cast<int64_t>(ctx->frames.size())) {
+        return false;
+    }
+
+    auto index = static_cast<size_t>(target);
+    size_t start;
+
+    if (ctx->decoded_index < index && !ctx->frames[index].keyframe) {
+        // Continue from the state at the cursor.
+        start = ctx->decoded_index + 1;
+    } else {
+        start = index;
+
+        while (!ctx->frames[start].keyframe) {
+            --start;
+        }
+    }
+
+    for (auto i = start; i <= index; ++i) {
+        DecodeState(ctx->frames[i].data, ctx->decoded);
+    }
+
+    ctx->decoded_index = index;
+    ctx->cursor = index;
+    ApplyState(registry, ctx->settings, ctx->decoded);
+    DequantizeContacts(ctx->settings, ctx->decoded, ctx->contacts);
+
+    return true;
+}
+
+bool IsRewound(entt::registry &registry) {
+    auto *ctx = registry.ctx().find<RewindContext>();
+    return ctx != nullptr && ctx->cursor + 1 < ctx->frames.size();
+}
+
+const std::vector<RewindContact> &GetRewindContacts(entt::registry &registry) {
+    auto &ctx = registry.ctx().get<RewindContext>();
+
+    if (ctx.cursor + 1 < ctx.frames.size() && ctx.decoded_index == ctx.cursor) {
+        return ctx.contacts;
+    }
+
+    return ctx.no_contacts;
+}
+
+bool ExportRewindReplay(entt::registry &registry, const std::string &path) {
+    auto *ctx = registry.ctx().find<RewindContext>();
+
+    if (ctx == nullptr || ctx->frames.empty()) {
+        return false;
+    }
+
+    auto file = std::ofstream(path, std::ios::binary | std::ios::trunc);
+
+    if (!file) {
+        return false;
+    }
+
+    auto header = RewindReplayHeader{};
+    header.position_step = static_cast<float>(ctx->settings.position_step);
+    header.orientation_step = static_cast<float>(ctx->settings.orientation_step);
+    header.velocity_step = static_cast<float>(ctx->settings.velocity_step);
+    header.impulse_step = static_cast<float>(ctx->settings.impulse_step);
+    header.num_frames = static_cast<uint32_t>(ctx->frames.size());
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    for (auto &frame : ctx->frames) {
+        auto frame_header = RewindReplayFrame{};
+        frame_header.time = frame.time;
+        frame_header.keyframe = frame.keyframe;
+        frame_header.size = static_cast<uint32_t>(frame.data.size());
+        file.write(reinterpret_cast<const char *>(&frame_header), sizeof(frame_header));
+        file.write(reinterpret_cast<const char *>(frame.data.data()), frame.data.size());
+    }
+
+    return static_cast<bool>(file);
+}
+
+RewindStats GetRewindStats(entt::registry &registry) {
+    auto stats = RewindStats{};
+    auto *ctx = registry.ctx().find<RewindContext>();
+
+    if (ctx == nullptr) {
+        return stats;
+    }
+
+    stats.num_frames = ctx->frames.size();
+
+    for (auto &frame : ctx->frames) {
+        stats.used_bytes += frame.data.size();
+    }
+
+    for (auto &buffer : ctx->pool) {
+        stats.pooled_bytes += buffer.capacity();
+    }
+
+    if (!ctx->frames.empty()) {
+        stats.window_duration = ctx->frames.back().time - ctx->frames.front().time;
+    }
+
+    return stats;
+}
@@ -0,0 +1,87 @@
+#include "rigidbody_batch.hpp"
+#include "shape_swap.hpp"
+#include <array>
+#include <utility>
+#include <variant>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+template<typename Component>
+static void ReserveStorage(entt::registry &registry, size_t count) {
+    auto &storage = registry.storage<Component>();
+    storage.reserve(storage.size() + count);
+}
+
+template<size_t... Is>
+static void ReserveShapeStorage(entt::registry &registry, const std::array<size_t, sizeof...(Is)> &counts,
+                                std::index_sequence<Is...>) {
+    ((counts[Is] > 0 ? ReserveStorage<std::variant_alternative_t<Is, edyn::shapes_variant_t>>(registry, counts[Is]) : void()), ...);
+}
+
+// Reserves space for the components every rigid body has, plus the shape
+// components of the given definitions, each used by `bodies_per_def` bodies.
+static void ReserveRigidBodyStorage(entt::registry &registry, const edyn::rigidbody_def *defs,
+                                    size_t num_defs, size_t bodies_per_def) {
+    auto count = num_defs * bodies_per_def;
+    ReserveStorage<edyn::position>(registry, count);
+    ReserveStorage<edyn::orientation>(registry, count);
+    ReserveStorage<edyn::linvel>(registry, count);
+    ReserveStorage<edyn::angvel>(registry, count);
+    ReserveStorage<edyn::mass>(registry, count);
+    ReserveStorage<edyn::AABB>(registry, count);
+    ReserveStorage<edyn::shape_index>(registry, count);
+    ReserveStorage<edyn::present_position>(registry, count);
+    ReserveStorage<edyn::present_orientation>(registry, count);
+
+    auto shape_counts = std::array<size_t, std::variant_size_v<edyn::shapes_variant_t>>{};
+
+    for (size_t i = 0; i < num_defs; ++i) {
+        if (defs[i].shape) {
+            shape_counts[defs[i].shape->index()] += bodies_per_def;
+        }
+    }
+
+    ReserveShapeStorage(registry, shape_counts, std::make_index_sequence<std::variant_size_v<edyn::shapes_variant_t>>{});
+}
+
+static bool NeedsInertia(const edyn::rigidbody_def &def) {
+    return def.kind == edyn::rigidbody_kind::rb_dynamic && def.shape && !def.inertia;
+}
+
+std::vector<entt::entity> MakeRigidBodies(entt::registry &registry, const edyn::rigidbody_def *defs, size_t count) {
+    auto entities = std::vector<entt::entity>(count);
+    ReserveRigidBodyStorage(registry, defs, count, 1);
+    registry.create(entities.begin(), entities.end());
+
+    for (size_t i = 0; i < count; ++i) {
+        if (NeedsInertia(defs[i])) {
+            auto def = defs[i];
+            def.inertia = GetShapeInertia(registry, *def.shape, def.mass);
+            edyn::make_rigidbody(entities[i], registry, def);
+        } else {
+            edyn::make_rigidbody(entities[i], registry, defs[i]);
+        }
+    }
+
+    return entities;
+}
+
+std::vector<entt::entity> MakeRigidBodies(entt::registry &registry, const edyn::rigidbody_def &def,
+                                          const edyn::vector3 *positions, size_t count) {
+    auto entities = std::vector<entt::entity>(count);
+    ReserveRigidBodyStorage(registry, &def, 1, count);
+    registry.create(entities.begin(), entities.end());
+
+    auto body_def = def;
+
+    if (NeedsInertia(body_def)) {
+        body_def.inertia = GetShapeInertia(registry, *body_def.shape, body_def.mass);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        body_def.position = positions[i];
+        edyn::make_rigidbody(entities[i], registry, body_def);
+    }
+
+    return entities;
+}
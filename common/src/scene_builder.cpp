@@ -0,0 +1,140 @@
+#include "scene_builder.hpp"
+#include <chrono>
+#include <thread>
+#include <edyn/context/task.hpp>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+void SceneBuilder::LoadTask::run(unsigned start, unsigned end) {
+    func();
+    done.store(true, std::memory_order_release);
+}
+
+void SceneBuilder::load(std::string label, load_func_t func) {
+    auto &stage = m_stages.emplace_back();
+    stage.kind = StageKind::Load;
+    stage.label = std::move(label);
+    stage.task = std::make_unique<LoadTask>();
+    stage.task->func = std::move(func);
+    ++m_num_stages;
+    m_static_world_ready = false;
+}
+
+void SceneBuilder::build(std::string label, build_func_t func) {
+    auto &stage = m_stages.emplace_back();
+    stage.kind = StageKind::Build;
+    stage.label = std::move(label);
+    stage.build = std::move(func);
+    ++m_num_stages;
+    m_static_world_ready = false;
+}
+
+void SceneBuilder::buildBatched(std::string label, size_t count, batch_func_t func) {
+    auto &stage = m_stages.emplace_back();
+    stage.kind = StageKind::Batch;
+    stage.label = std::move(label);
+    stage.batch = std::move(func);
+    stage.count = count;
+    ++m_num_stages;
+    m_static_world_ready = false;
+}
+
+void SceneBuilder::staticWorldReady() {
+    auto &stage = m_stages.emplace_back();
+    stage.kind = StageKind::StaticWorldReady;
+    ++m_num_stages;
+    m_static_world_ready = false;
+}
+
+void SceneBuilder::update(entt::registry &registry, double time_budget) {
+    using clock = std::chrono::steady_clock;
+    auto deadline = clock::now() + std::chrono::duration_cast<clock::duration>(
+        std::chrono::duration<double>(time_budget));
+
+    while (!m_stages.empty()) {
+        // Start all loads at the front so they run concurrently, including
+        // the ones after a load that's still running.
+        for (auto &stage : m_stages) {
+            if (stage.kind != StageKind::Load) {
+                break;
+            }
+
+            if (!stage.launched) {
+                auto task = edyn::task_delegate_t(entt::connect_arg_t<&LoadTask::run>{}, *stage.task);
+                (*edyn::get_enqueue_task(registry))(task, 1, {});
+                stage.launched = true;
+            }
+        }
+
+        auto &stage = m_stages.front();
+
+        switch (stage.kind) {
+        case StageKind::Load:
+            if (!stage.task->done.load(std::memory_order_acquire)) {
+                return;
+            }
+            break;
+        case StageKind::Build:
+            stage.build(registry);
+            break;
+        case StageKind::Batch:
+            while (stage.next < stage.count && clock::now() < deadline) {
+                stage.batch(registry, stage.next++);
+            }
+
+            if (stage.next < stage.count) {
+                return;
+            }
+            break;
+        case StageKind::StaticWorldReady:
+            m_static_world_ready = true;
+            break;
+        }
+
+        m_stages.pop_front();
+        ++m_num_completed;
+
+        if (clock::now() >= deadline) {
+            break;
+        }
+    }
+
+    if (m_stages.empty()) {
+        m_static_world_ready = true;
+        m_num_stages = m_num_completed = 0;
+    }
+}
+
+void SceneBuilder::cancel() {
+    for (auto &stage : m_stages) {
+        if (stage.launched) {
+            while (!stage.task->done.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    m_stages.clear();
+    m_num_stages = m_num_completed = 0;
+    m_static_world_ready = true;
+}
+
+float SceneBuilder::progress() const {
+    if (m_stages.empty()) {
+        return 1;
+    }
+
+    auto completed = float(m_num_completed);
+    auto &stage = m_stages.front();
+
+    if (stage.kind == StageKind::Batch && stage.count > 0) {
+        completed += float(stage.next) / float(stage.count);
+    }
+
+    return completed / float(m_num_stages);
+}
+
+const std::string &SceneBuilder::currentLabel() const {
+    static const std::string empty;
+    return m_stages.empty() ? empty : m_stages.front().label;
+}
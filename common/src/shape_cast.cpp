@@ -0,0 +1,605 @@
+#include "shape_cast.hpp"
+#include "collision_query_world.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <variant>
+#include <edyn/context/task.hpp>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+// Distance at which the swept shape is considered to be touching.
+static constexpr edyn::scalar ShapeCastTolerance = 0.001;
+static constexpr int ShapeCastMaxIterations = 32;
+static constexpr int GjkMaxIterations = 64;
+
+// The swept shape: a point or box, inflated by `radius`.
+struct ShapeCaster {
+    edyn::vector3 half_extents;
+    edyn::quaternion orn;
+    edyn::scalar radius;
+    bool is_box;
+
+    edyn::vector3 support(const edyn::vector3 &center, const edyn::vector3 &dir) const {
+        if (!is_box) {
+            return center;
+        }
+
+        auto local_dir = edyn::rotate(edyn::conjugate(orn), dir);
+        auto local_pt = edyn::vector3{
+            local_dir.x < 0 ? -half_extents.x : half_extents.x,
+            local_dir.y < 0 ? -half_extents.y : half_extents.y,
+            local_dir.z < 0 ? -half_extents.z : half_extents.z
+        };
+        return center + edyn::rotate(orn, local_pt);
+    }
+
+    edyn::AABB aabb(const edyn::vector3 &center) const {
+        auto extents = edyn::vector3_one * radius;
+
+        if (is_box) {
+            for (int i = 0; i < 3; ++i) {
+                auto axis = edyn::rotate(orn, edyn::coordinate_axis_vector(static_cast<edyn::coordinate_axis>(i)));
+                extents += edyn::vector3{std::abs(axis.x), std::abs(axis.y), std::abs(axis.z)} * half_extents[i];
+            }
+        }
+
+        return {center - extents, center + extents};
+    }
+};
+
+struct ShapeCastHit {
+    edyn::scalar fraction {std::numeric_limits<edyn::scalar>::max()};
+    edyn::vector3 normal;
+    decltype(edyn::shape_raycast_result::info_var) info_var;
+};
+
+// Closest point to the origin in the simplex, which is reduced to the
+// smallest sub-simplex containing that point.
+static edyn::vector3 ReduceSimplex(std::array<edyn::vector3, 4> &simplex, int &count) {
+    auto closest_on_segment = [](const edyn::vector3 &a, const edyn::vector3 &b, edyn::scalar &t) {
+        auto ab = b - a;
+        auto denom = edyn::dot(ab, ab);
+        t = denom > EDYN_EPSILON ? std::clamp(-edyn::dot(a, ab) / denom, edyn::scalar(0), edyn::scalar(1)) : 0;
+        return a + ab * t;
+    };
+
+    // Closest point on triangle, from Real-Time Collision Detection 5.1.5.
+    // Returns the indices of the vertices spanning the closest feature.
+    auto closest_on_triangle = [](const edyn::vector3 &a, const edyn::vector3 &b, const edyn::vector3 &c,
+                                  std::array<int, 3> &feature, int &feature_size) {
+        auto ab = b - a, ac = c - a, ap = -a;
+        auto d1 = edyn::dot(ab, ap), d2 = edyn::dot(ac, ap);
+        if (d1 <= 0 && d2 <= 0) { feature = {0}; feature_size = 1; return a; }
+
+        auto bp = -b;
+        auto d3 = edyn::dot(ab, bp), d4 = edyn::dot(ac, bp);
+        if (d3 >= 0 && d4 <= d3) { feature = {1}; feature_size = 1; return b; }
+
+        auto vc = d1 * d4 - d3 * d2;
+        if (vc <= 0 && d1 >= 0 && d3 <= 0) {
+            feature = {0, 1}; feature_size = 2;
+            return a + ab * (d1 / (d1 - d3));
+        }
+
+        auto cp = -c;
+        auto d5 = edyn::dot(ab, cp), d6 = edyn::dot(ac, cp);
+        if (d6 >= 0 && d5 <= d6) { feature = {2}; feature_size = 1; return c; }
+
+        auto vb = d5 * d2 - d1 * d6;
+        if (vb <= 0 && d2 >= 0 && d6 <= 0) {
+            feature = {0, 2}; feature_size = 2;
+            return a + ac * (d2 / (d2 - d6));
+        }
+
+        auto va = d3 * d6 - d5 * d4;
+        if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) {
+            feature = {1, 2}; feature_size = 2;
+            return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+        }
+
+        auto denom = edyn::scalar(1) / (va + vb + vc);
+        feature = {0, 1, 2}; feature_size = 3;
+        return a + ab * (vb * denom) + ac * (vc * denom);
+    };
+
+    switch (count) {
+    case 1:
+        return simplex[0];
+    case 2: {
+        edyn::scalar t;
+        auto p = closest_on_segment(simplex[0], simplex[1], t);
+
+        if (t <= 0) {
+            count = 1;
+        } else if (t >= 1) {
+            simplex[0] = simplex[1];
+            count = 1;
+        }
+
+        return p;
+    }
+    case 3: {
+        std::array<int, 3> feature;
+        int feature_size;
+        auto p = closest_on_triangle(simplex[0], simplex[1], simplex[2], feature, feature_size);
+        auto reduced = std::array<edyn::vector3, 4>{};
+
+        for (int i = 0; i < feature_size; ++i) {
+            reduced[i] = simplex[feature[i]];
+        }
+
+        simplex = reduced;
+        count = feature_size;
+        return p;
+    }
+    default: {
+        // Check each face of the tetrahedron facing the origin.
+        static constexpr int faces[4][4] = {{0, 1, 2, 3}, {0, 2, 3, 1}, {0, 3, 1, 2}, {1, 3, 2, 0}};
+        auto best_dist_sqr = std::numeric_limits<edyn::scalar>::max();
+        auto best_point = edyn::vector3_zero;
+        auto best_simplex = simplex;
+        auto best_count = 4;
+
+        for (auto &face : faces) {
+            auto &a = simplex[face[0]], &b = simplex[face[1]], &c = simplex[face[2]], &d = simplex[face[3]];
+            auto normal = edyn::cross(b - a, c - a);
+            auto side_origin = edyn::dot(-a, normal);
+            auto side_opposite = edyn::dot(d - a, normal);
+
+            // Skip faces with the origin on the same side as the opposite
+            // vertex.
+            if (side_origin * side_opposite > 0) {
+                continue;
+            }
+
+            std::array<int, 3> feature;
+            int feature_size;
+            auto p = closest_on_triangle(a, b, c, feature, feature_size);
+            auto dist_sqr = edyn::length_sqr(p);
+
+            if (dist_sqr < best_dist_sqr) {
+                best_dist_sqr = dist_sqr;
+                best_point = p;
+                best_count = feature_size;
+
+                for (int i = 0; i < feature_size; ++i) {
+                    best_simplex[i] = simplex[face[feature[i]]];
+                }
+            }
+        }
+
+        // Origin is inside the tetrahedron if no face faces it.
+        if (best_count == 4) {
+            return edyn::vector3_zero;
+        }
+
+        simplex = best_simplex;
+        count = best_count;
+        return best_point;
+    }
+    }
+}
+
+// Distance between two convex shapes given by their support functions using
+// GJK. Returns false if they intersect. Otherwise, `v` is the vector from the
+// closest point on B to the closest point on A.
+template<typename SupportA, typename SupportB>
+static bool GjkDistance(SupportA &&support_a, SupportB &&support_b, edyn::vector3 &v) {
+    auto simplex = std::array<edyn::vector3, 4>{};
+    auto count = 0;
+    v = support_a(edyn::vector3_x) - support_b(-edyn::vector3_x);
+
+    for (int i = 0; i < GjkMaxIterations; ++i) {
+        auto dist_sqr = edyn::length_sqr(v);
+
+        if (dist_sqr < EDYN_EPSILON * EDYN_EPSILON) {
+            return false;
+        }
+
+        auto w = support_a(-v) - support_b(v);
+
+        // No significant progress, `v` is the closest point.
+        if (dist_sqr - edyn::dot(v, w) <= dist_sqr * edyn::scalar(1e-6)) {
+            return true;
+        }
+
+        simplex[count++] = w;
+        v = ReduceSimplex(simplex, count);
+
+        if (count == 4) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Time of impact between the caster and a convex shape using conservative
+// advancement: at each iteration, move the caster forward by the distance
+// between both shapes divided by the speed along the separating direction.
+template<typename SupportB>
+static bool SweepConvex(const ShapeCaster &caster, const edyn::vector3 &p0, const edyn::vector3 &delta,
+                        SupportB &&support_b, ShapeCastHit &hit) {
+    edyn::scalar t = 0;
+
+    for (int i = 0; i < ShapeCastMaxIterations; ++i) {
+        auto center = p0 + delta * t;
+        auto support_a = [&](const edyn::vector3 &dir) { return caster.support(center, dir); };
+        edyn::vector3 v;
+
+        if (!GjkDistance(support_a, support_b, v)) {
+            // Cores are overlapping. Only happens when starting in contact.
+            if (t < hit.fraction) {
+                hit.fraction = t;
+                hit.normal = edyn::length_sqr(delta) > EDYN_EPSILON ? -edyn::normalize(delta) : edyn::vector3_y;
+                hit.info_var = {};
+                return true;
+            }
+            return false;
+        }
+
+        auto len = edyn::length(v);
+        auto dist = len - caster.radius;
+        auto normal = v / len;
+
+        if (dist < ShapeCastTolerance) {
+            if (t < hit.fraction) {
+                hit.fraction = t;
+                hit.normal = normal;
+                hit.info_var = {};
+                return true;
+            }
+            return false;
+        }
+
+        auto approach_speed = -edyn::dot(delta, normal);
+
+        if (approach_speed <= EDYN_EPSILON) {
+            return false;
+        }
+
+        t += dist / approach_speed;
+
+        if (t > 1 || t >= hit.fraction) {
+            return false;
+        }
+    }
+
+    return false;
+}
+
+static auto SphereSupport(const edyn::vector3 &center, edyn::scalar radius) {
+    return [=](const edyn::vector3 &dir) {
+        auto len_sqr = edyn::length_sqr(dir);
+        return len_sqr > EDYN_EPSILON ? center + dir * (radius / std::sqrt(len_sqr)) : center;
+    };
+}
+
+static auto TriangleSupport(const std::array<edyn::vector3, 3> &vertices) {
+    return [=](const edyn::vector3 &dir) {
+        auto d0 = edyn::dot(vertices[0], dir);
+        auto d1 = edyn::dot(vertices[1], dir);
+        auto d2 = edyn::dot(vertices[2], dir);
+        return d0 > d1 ? (d0 > d2 ? vertices[0] : vertices[2]) : (d1 > d2 ? vertices[1] : vertices[2]);
+    };
+}
+
+static auto ConvexSupport(const edyn::sphere_shape &sh, const edyn::vector3 &pos, const edyn::quaternion &) {
+    return SphereSupport(pos, sh.radius);
+}
+
+static auto ConvexSupport(const edyn::box_shape &sh, const edyn::vector3 &pos, const edyn::quaternion &orn) {
+    auto caster = ShapeCaster{sh.half_extents, orn, 0, true};
+    return [=](const edyn::vector3 &dir) { return caster.support(pos, dir); };
+}
+
+static auto ConvexSupport(const edyn::capsule_shape &sh, const edyn::vector3 &pos, const edyn::quaternion &orn) {
+    auto axis = edyn::rotate(orn, edyn::coordinate_axis_vector(sh.axis));
+    return [=](const edyn::vector3 &dir) {
+        auto end = pos + axis * (edyn::dot(dir, axis) < 0 ? -sh.half_length : sh.half_length);
+        return SphereSupport(end, sh.radius)(dir);
+    };
+}
+
+static auto ConvexSupport(const edyn::cylinder_shape &sh, const edyn::vector3 &pos, const edyn::quaternion &orn) {
+    auto axis = edyn::rotate(orn, edyn::coordinate_axis_vector(sh.axis));
+    return [=](const edyn::vector3 &dir) {
+        auto axial = edyn::dot(dir, axis);
+        auto radial = dir - axis * axial;
+        auto radial_len_sqr = edyn::length_sqr(radial);
+        auto pt = pos + axis * (axial < 0 ? -sh.half_length : sh.half_length);
+
+        if (radial_len_sqr > EDYN_EPSILON) {
+            pt += radial * (sh.radius / std::sqrt(radial_len_sqr));
+        }
+
+        return pt;
+    };
+}
+
+static auto ConvexSupport(const edyn::polyhedron_shape &sh, const edyn::vector3 &pos, const edyn::quaternion &orn) {
+    auto *mesh = sh.mesh.get();
+    return [=](const edyn::vector3 &dir) {
+        auto local_dir = edyn::rotate(edyn::conjugate(orn), dir);
+        auto best = mesh->vertices.front();
+        auto best_proj = edyn::dot(best, local_dir);
+
+        for (auto &vertex : mesh->vertices) {
+            auto proj = edyn::dot(vertex, local_dir);
+
+            if (proj > best_proj) {
+                best_proj = proj;
+                best = vertex;
+            }
+        }
+
+        return edyn::to_world_space(best, pos, orn);
+    };
+}
+
+template<typename Shape>
+static void SweepShape(const ShapeCaster &caster, const edyn::vector3 &p0, const edyn::vector3 &delta,
+                       const Shape &shape, const edyn::vector3 &pos, const edyn::quaternion &orn,
+                       ShapeCastHit &hit) {
+    SweepConvex(caster, p0, delta, ConvexSupport(shape, pos, orn), hit);
+}
+
+static void SweepShape(const ShapeCaster &caster, const edyn::vector3 &p0, const edyn::vector3 &delta,
+                       const edyn::plane_shape &shape, const edyn::vector3 &pos, const edyn::quaternion &orn,
+                       ShapeCastHit &hit) {
+    auto normal = edyn::rotate(orn, shape.normal);
+    auto constant = shape.constant + edyn::dot(normal, pos);
+    auto support = caster.support(p0, -normal);
+    auto dist = edyn::dot(normal, support) - constant - caster.radius;
+    auto approach_speed = -edyn::dot(normal, delta);
+    edyn::scalar t;
+
+    if (dist <= 0) {
+        t = 0;
+    } else if (approach_speed > EDYN_EPSILON && dist <= approach_speed) {
+        t = dist / approach_speed;
+    } else {
+        return;
+    }
+
+    if (t < hit.fraction) {
+        hit.fraction = t;
+        hit.normal = normal;
+        hit.info_var = {};
+    }
+}
+
+// AABB in object space enclosing a world space AABB.
+static edyn::AABB ToObjectSpace(const edyn::AABB &aabb, const edyn::vector3 &pos, const edyn::quaternion &orn) {
+    auto result = edyn::AABB{edyn::vector3_max, -edyn::vector3_max};
+
+    for (int i = 0; i < 8; ++i) {
+        auto corner = edyn::vector3{
+            i & 1 ? aabb.max.x : aabb.min.x,
+            i & 2 ? aabb.max.y : aabb.min.y,
+            i & 4 ? aabb.max.z : aabb.min.z
+        };
+        auto local = edyn::to_object_space(corner, pos, orn);
+        result.min = edyn::min(result.min, local);
+        result.max = edyn::max(result.max, local);
+    }
+
+    return result;
+}
+
+static edyn::AABB SweptAABB(const ShapeCaster &caster, const edyn::vector3 &p0, const edyn::vector3 &delta) {
+    auto aabb0 = caster.aabb(p0);
+    auto aabb1 = caster.aabb(p0 + delta);
+    auto margin = edyn::vector3_one * ShapeCastTolerance;
+    return {edyn::min(aabb0.min, aabb1.min) - margin, edyn::max(aabb0.max, aabb1.max) + margin};
+}
+
+static void SweepShape(const ShapeCaster &caster, const edyn::vector3 &p0, const edyn::vector3 &delta,
+                       const edyn::mesh_shape &shape, const edyn::vector3 &pos, const edyn::quaternion &orn,
+                       ShapeCastHit &hit) {
+    auto local_aabb = ToObjectSpace(SweptAABB(caster, p0, delta), pos, orn);
+
+    shape.trimesh->visit_triangles(local_aabb, [&](auto tri_idx) {
+        auto vertices = shape.trimesh->get_triangle_vertices(tri_idx);
+
+        for (auto &v : vertices) {
+            v = edyn::to_world_space(v, pos, orn);
+        }
+
+        if (SweepConvex(caster, p0, delta, TriangleSupport(vertices), hit)) {
+            auto info = edyn::mesh_raycast_info{};
+            info.triangle_index = tri_idx;
+            hit.info_var = info;
+        }
+    });
+}
+
+static void SweepShape(const ShapeCaster &caster, const edyn::vector3 &p0, const edyn::vector3 &delta,
+                       const edyn::paged_mesh_shape &shape, const edyn::vector3 &pos, const edyn::quaternion &orn,
+                       ShapeCastHit &hit) {
+    auto local_aabb = ToObjectSpace(SweptAABB(caster, p0, delta), pos, orn);
+
+    shape.trimesh->visit_triangles(local_aabb, [&](auto mesh_idx, auto tri_idx) {
+        auto vertices = shape.trimesh->get_triangle_vertices(mesh_idx, tri_idx);
+
+        for (auto &v : vertices) {
+            v = edyn::to_world_space(v, pos, orn);
+        }
+
+        if (SweepConvex(caster, p0, delta, TriangleSupport(vertices), hit)) {
+            auto info = edyn::paged_mesh_raycast_info{};
+            info.submesh_index = mesh_idx;
+            info.triangle_index = tri_idx;
+            hit.info_var = info;
+        }
+    });
+}
+
+static void SweepShape(const ShapeCaster &caster, const edyn::vector3 &p0, const edyn::vector3 &delta,
+                       const edyn::compound_shape &shape, const edyn::vector3 &pos, const edyn::quaternion &orn,
+                       ShapeCastHit &hit) {
+    for (size_t i = 0; i < shape.nodes.size(); ++i) {
+        auto &node = shape.nodes[i];
+        auto child_pos = edyn::to_world_space(node.position, pos, orn);
+        auto child_orn = orn * node.orientation;
+        auto child_hit = ShapeCastHit{};
+        child_hit.fraction = hit.fraction;
+
+        std::visit([&](auto &&child) {
+            SweepShape(caster, p0, delta, child, child_pos, child_orn, child_hit);
+        }, node.shape_var);
+
+        if (child_hit.fraction < hit.fraction) {
+            hit.fraction = child_hit.fraction;
+            hit.normal = child_hit.normal;
+            auto info = edyn::compound_raycast_info{};
+            info.child_index = i;
+            hit.info_var = info;
+        }
+    }
+}
+
+static ShapeCaster MakeCaster(const ShapeCast &cast) {
+    if (cast.kind == ShapeCastKind::Box) {
+        return {cast.half_extents, cast.orientation, 0, true};
+    }
+
+    return {edyn::vector3_zero, edyn::quaternion_identity, cast.radius, false};
+}
+
+static edyn::raycast_result ShapeCastQuery(const CollisionQueryWorld &world, const ShapeCast &cast,
+                                           std::vector<entt::entity> &candidates) {
+    auto caster = MakeCaster(cast);
+    auto delta = cast.p1 - cast.p0;
+
+    candidates.clear();
+    world.bphase->query(SweptAABB(caster, cast.p0, delta), [&](entt::entity entity) {
+        if (entity != cast.ignore[0] && entity != cast.ignore[1]) {
+            candidates.push_back(entity);
+        }
+    });
+
+    auto result = edyn::raycast_result{};
+    auto hit = ShapeCastHit{};
+
+    for (auto entity : candidates) {
+        auto sh_idx = world.index_view.get<edyn::shape_index>(entity);
+        auto pos = world.getOrigin(entity);
+        auto &orn = world.tr_view.get<edyn::orientation>(entity);
+        auto prev_fraction = hit.fraction;
+
+        edyn::visit_shape(sh_idx, entity, world.shape_views_tuple, [&](auto &&shape) {
+            SweepShape(caster, cast.p0, delta, shape, pos, orn, hit);
+        });
+
+        if (hit.fraction < prev_fraction) {
+            result.entity = entity;
+        }
+    }
+
+    if (result.entity != entt::null) {
+        result.fraction = hit.fraction;
+        result.normal = hit.normal;
+        result.info_var = hit.info_var;
+    }
+
+    return result;
+}
+
+edyn::raycast_result ShapeCastQuery(entt::registry &registry, const ShapeCast &cast) {
+    auto world = CollisionQueryWorld(registry);
+    auto candidates = std::vector<entt::entity>{};
+    return ShapeCastQuery(world, cast, candidates);
+}
+
+edyn::raycast_result SphereCast(entt::registry &registry, edyn::vector3 p0, edyn::vector3 p1, edyn::scalar radius,
+                                std::array<entt::entity, 2> ignore) {
+    auto cast = ShapeCast{};
+    cast.kind = ShapeCastKind::Sphere;
+    cast.p0 = p0;
+    cast.p1 = p1;
+    cast.radius = radius;
+    cast.ignore = ignore;
+    return ShapeCastQuery(registry, cast);
+}
+
+edyn::raycast_result BoxCast(entt::registry &registry, edyn::vector3 p0, edyn::vector3 p1,
+                             edyn::vector3 half_extents, edyn::quaternion orientation,
+                             std::array<entt::entity, 2> ignore) {
+    auto cast = ShapeCast{};
+    cast.kind = ShapeCastKind::Box;
+    cast.p0 = p0;
+    cast.p1 = p1;
+    cast.half_extents = half_extents;
+    cast.orientation = orientation;
+    cast.ignore = ignore;
+    return ShapeCastQuery(registry, cast);
+}
+
+struct ShapeCastQueue {
+    // Minimum number of casts before they're split among the workers of the
+    // task scheduler.
+    static constexpr size_t parallel_threshold = 16;
+
+    std::vector<ShapeCast> casts;
+    std::vector<ShapeCastDelegate> delegates;
+    std::vector<edyn::raycast_result> results;
+
+    // Only valid during a flush.
+    const CollisionQueryWorld *world;
+
+    void compute(unsigned start, unsigned end) {
+        auto candidates = std::vector<entt::entity>{};
+
+        for (auto i = start; i < end; ++i) {
+            results[i] = ShapeCastQuery(*world, casts[i], candidates);
+        }
+    }
+};
+
+void ShapeCastAsync(entt::registry &registry, const ShapeCast &cast, ShapeCastDelegate delegate) {
+    auto *queue = registry.ctx().find<ShapeCastQueue>();
+
+    if (queue == nullptr) {
+        queue = &registry.ctx().emplace<ShapeCastQueue>();
+    }
+
+    queue->casts.push_back(cast);
+    queue->delegates.push_back(delegate);
+}
+
+void FlushShapeCasts(entt::registry &registry) {
+    auto *queue = registry.ctx().find<ShapeCastQueue>();
+
+    if (queue == nullptr || queue->casts.empty()) {
+        return;
+    }
+
+    auto world = CollisionQueryWorld(registry);
+    queue->world = &world;
+    queue->results.resize(queue->casts.size());
+
+    auto num_casts = static_cast<unsigned>(queue->casts.size());
+
+    if (num_casts >= ShapeCastQueue::parallel_threshold) {
+        auto task = edyn::task_delegate_t(entt::connect_arg_t<&ShapeCastQueue::compute>{}, *queue);
+        auto enqueue_task_wait = edyn::get_enqueue_task_wait(registry);
+        enqueue_task_wait(task, num_casts);
+    } else {
+        queue->compute(0, num_casts);
+    }
+
+    queue->world = nullptr;
+
+    // Move out before invoking delegates since they might queue more casts.
+    auto casts = std::move(queue->casts);
+    auto delegates = std::move(queue->delegates);
+    auto results = std::move(queue->results);
+    queue->casts.clear();
+    queue->delegates.clear();
+
+    for (size_t i = 0; i < casts.size(); ++i) {
+        delegates[i](casts[i], results[i]);
+    }
+}
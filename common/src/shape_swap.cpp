@@ -0,0 +1,190 @@
+#include "shape_swap.hpp"
+#include <array>
+#include <memory>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include <edyn/dynamics/moment_of_inertia.hpp>
+#include <edyn/util/rigidbody.hpp>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+struct ShapeInertiaKey {
+    size_t shape_index {};
+    std::array<edyn::scalar, 4> params {};
+    const void *data {nullptr};
+    edyn::scalar mass {};
+
+    bool operator==(const ShapeInertiaKey &other) const {
+        return shape_index == other.shape_index && params == other.params &&
+               data == other.data && mass == other.mass;
+    }
+};
+
+struct ShapeInertiaCache {
+    // Caches are expected to hold a handful of shapes, thus a linear search
+    // is fine. The oldest entry is replaced once full.
+    static constexpr size_t max_entries = 64;
+
+    struct Entry {
+        ShapeInertiaKey key;
+        edyn::matrix3x3 inertia;
+        // Keeps the mesh alive so its address is not reused by another mesh
+        // while cached.
+        std::shared_ptr<const void> data_owner;
+    };
+
+    std::vector<Entry> entries;
+    size_t next_replace {};
+};
+
+static std::array<edyn::scalar, 4> ShapeParams(const edyn::sphere_shape &sh) {
+    return {sh.radius};
+}
+
+static std::array<edyn::scalar, 4> ShapeParams(const edyn::box_shape &sh) {
+    return {sh.half_extents.x, sh.half_extents.y, sh.half_extents.z};
+}
+
+static std::array<edyn::scalar, 4> ShapeParams(const edyn::cylinder_shape &sh) {
+    return {sh.radius, sh.half_length, edyn::scalar(static_cast<int>(sh.axis))};
+}
+
+static std::array<edyn::scalar, 4> ShapeParams(const edyn::capsule_shape &sh) {
+    return {sh.radius, sh.half_length, edyn::scalar(static_cast<int>(sh.axis))};
+}
+
+static std::array<edyn::scalar, 4> ShapeParams(const edyn::plane_shape &sh) {
+    return {sh.normal.x, sh.normal.y, sh.normal.z, sh.constant};
+}
+
+template<typename Shape>
+static std::array<edyn::scalar, 4> ShapeParams(const Shape &) {
+    return {};
+}
+
+template<typename Shape>
+static std::shared_ptr<const void> ShapeData(const Shape &) {
+    return {};
+}
+
+static std::shared_ptr<const void> ShapeData(const edyn::polyhedron_shape &sh) {
+    return sh.mesh;
+}
+
+static std::shared_ptr<const void> ShapeData(const edyn::mesh_shape &sh) {
+    return sh.trimesh;
+}
+
+static std::shared_ptr<const void> ShapeData(const edyn::paged_mesh_shape &sh) {
+    return sh.trimesh;
+}
+
+template<typename Variant>
+static bool IsSameShapeVariant(const Variant &a, const Variant &b) {
+    if (a.index() != b.index()) {
+        return false;
+    }
+
+    return std::visit([&](auto &&sh) {
+        auto &other = std::get<std::decay_t<decltype(sh)>>(b);
+        return ShapeParams(sh) == ShapeParams(other) && ShapeData(sh) == ShapeData(other);
+    }, a);
+}
+
+bool IsSameShape(const edyn::shapes_variant_t &a, const edyn::shapes_variant_t &b) {
+    if (!IsSameShapeVariant(a, b)) {
+        return false;
+    }
+
+    if (!std::holds_alternative<edyn::compound_shape>(a)) {
+        return true;
+    }
+
+    auto &nodes_a = std::get<edyn::compound_shape>(a).nodes;
+    auto &nodes_b = std::get<edyn::compound_shape>(b).nodes;
+
+    if (nodes_a.size() != nodes_b.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < nodes_a.size(); ++i) {
+        if (nodes_a[i].position != nodes_b[i].position ||
+            nodes_a[i].orientation != nodes_b[i].orientation ||
+            !IsSameShapeVariant(nodes_a[i].shape_var, nodes_b[i].shape_var)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+edyn::matrix3x3 GetShapeInertia(entt::registry &registry, const edyn::shapes_variant_t &shape, edyn::scalar mass) {
+    if (std::holds_alternative<edyn::compound_shape>(shape)) {
+        return edyn::moment_of_inertia(shape, mass);
+    }
+
+    auto *cache = registry.ctx().find<ShapeInertiaCache>();
+
+    if (cache == nullptr) {
+        cache = &registry.ctx().emplace<ShapeInertiaCache>();
+    }
+
+    auto key = ShapeInertiaKey{};
+    auto data_owner = std::shared_ptr<const void>{};
+    key.shape_index = shape.index();
+    key.mass = mass;
+
+    std::visit([&](auto &&sh) {
+        key.params = ShapeParams(sh);
+        data_owner = ShapeData(sh);
+        key.data = data_owner.get();
+    }, shape);
+
+    for (auto &entry : cache->entries) {
+        if (entry.key == key) {
+            return entry.inertia;
+        }
+    }
+
+    auto inertia = edyn::moment_of_inertia(shape, mass);
+    auto entry = ShapeInertiaCache::Entry{key, inertia, std::move(data_owner)};
+
+    if (cache->entries.size() < ShapeInertiaCache::max_entries) {
+        cache->entries.push_back(std::move(entry));
+    } else {
+        cache->entries[cache->next_replace] = std::move(entry);
+        cache->next_replace = (cache->next_replace + 1) % ShapeInertiaCache::max_entries;
+    }
+
+    return inertia;
+}
+
+void SetRigidBodiesShape(entt::registry &registry, const entt::entity *entities, size_t count,
+                         const edyn::shapes_variant_t &shape) {
+    auto mass_view = registry.view<edyn::mass>();
+    auto dynamic_view = registry.view<edyn::dynamic_tag>();
+    // Bodies swapped together usually share the same mass, thus skip the
+    // cache lookup when it repeats.
+    auto last_mass = edyn::scalar(-1);
+    auto inertia = edyn::matrix3x3{};
+
+    for (size_t i = 0; i < count; ++i) {
+        auto entity = entities[i];
+        edyn::rigidbody_set_shape(registry, entity, shape);
+
+        // Only dynamic bodies have a meaningful inertia.
+        if (!dynamic_view.contains(entity)) {
+            continue;
+        }
+
+        auto mass = edyn::scalar(mass_view.get<edyn::mass>(entity));
+
+        if (mass != last_mass) {
+            inertia = GetShapeInertia(registry, shape, mass);
+            last_mass = mass;
+        }
+
+        edyn::set_rigidbody_inertia(registry, entity, inertia);
+    }
+}
@@ -0,0 +1,312 @@
+#include "trigger_volume.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+// Overlap sets of all triggers in compressed rows, i.e. the bodies of the
+// trigger at index `i` are in `bodies[offsets[i]]` to `bodies[offsets[i + 1]]`.
+struct TriggerOverlapSets {
+    std::vector<entt::entity> triggers;
+    std::vector<uint32_t> offsets;
+    std::vector<entt::entity> bodies;
+
+    void clear() {
+        triggers.clear();
+        offsets.clear();
+        bodies.clear();
+    }
+};
+
+struct TriggerVolumeContext {
+    struct SweepItem {
+        edyn::AABB aabb;
+        uint32_t index;
+        bool is_trigger;
+    };
+
+    struct Pair {
+        uint32_t trigger_index;
+        entt::entity body;
+
+        bool operator<(const Pair &other) const {
+            return trigger_index < other.trigger_index ||
+                   (trigger_index == other.trigger_index && body < other.body);
+        }
+    };
+
+    TriggerOverlapSets previous;
+    TriggerOverlapSets current;
+    // Index of each trigger in `current` and `previous`, for lookups.
+    std::unordered_map<entt::entity, uint32_t> trigger_index;
+    std::unordered_map<entt::entity, uint32_t> prev_trigger_index;
+    std::vector<SweepItem> items;
+    std::vector<uint32_t> active_triggers;
+    std::vector<uint32_t> active_bodies;
+    std::vector<entt::entity> body_entities;
+    std::vector<Pair> pairs;
+    std::vector<TriggerEvent> events;
+};
+
+entt::entity CreateTriggerVolume(entt::registry &registry, const TriggerVolume &volume) {
+    auto entity = registry.create();
+    registry.emplace<TriggerVolume>(entity, volume);
+    return entity;
+}
+
+static std::array<edyn::vector3, 3> BoxAxes(const edyn::quaternion &orn) {
+    return {edyn::rotate(orn, edyn::vector3_x),
+            edyn::rotate(orn, edyn::vector3_y),
+            edyn::rotate(orn, edyn::vector3_z)};
+}
+
+edyn::AABB GetTriggerVolumeAABB(const TriggerVolume &volume) {
+    if (volume.shape == TriggerShape::Sphere) {
+        auto extents = edyn::vector3_one * volume.radius;
+        return {volume.position - extents, volume.position + extents};
+    }
+
+    auto axes = BoxAxes(volume.orientation);
+    auto extents = edyn::vector3_zero;
+
+    for (int i = 0; i < 3; ++i) {
+        extents += edyn::vector3{std::abs(axes[i].x), std::abs(axes[i].y), std::abs(axes[i].z)} * volume.half_extents[i];
+    }
+
+    return {volume.position - extents, volume.position + extents};
+}
+
+// Separating axis test between an oriented box and an AABB.
+static bool IntersectBoxAABB(const TriggerVolume &volume, const edyn::AABB &aabb) {
+    auto box_axes = BoxAxes(volume.orientation);
+    auto aabb_center = (aabb.min + aabb.max) * edyn::scalar(0.5);
+    auto aabb_half_extents = (aabb.max - aabb.min) * edyn::scalar(0.5);
+    auto t = aabb_center - volume.position;
+
+    auto separated = [&](const edyn::vector3 &axis) {
+        auto box_radius = edyn::scalar(0);
+
+        for (int i = 0; i < 3; ++i) {
+            box_radius += volume.half_extents[i] * std::abs(edyn::dot(box_axes[i], axis));
+        }
+
+        auto aabb_radius = aabb_half_extents.x * std::abs(axis.x) +
+                           aabb_half_extents.y * std::abs(axis.y) +
+                           aabb_half_extents.z * std::abs(axis.z);
+        return std::abs(edyn::dot(t, axis)) > box_radius + aabb_radius;
+    };
+
+    // The world axes were already tested by the AABB overlap.
+    for (auto &axis : box_axes) {
+        if (separated(axis)) {
+            return false;
+        }
+    }
+
+    for (auto &box_axis : box_axes) {
+        for (auto &world_axis : {edyn::vector3_x, edyn::vector3_y, edyn::vector3_z}) {
+            auto axis = edyn::cross(box_axis, world_axis);
+
+            // Parallel edges are covered by the face axes.
+            if (edyn::length_sqr(axis) > EDYN_EPSILON && separated(axis)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool IntersectSphereAABB(const TriggerVolume &volume, const edyn::AABB &aabb) {
+    auto closest = edyn::min(edyn::max(volume.position, aabb.min), aabb.max);
+    return edyn::distance_sqr(closest, volume.position) <= volume.radius * volume.radius;
+}
+
+static bool IntersectTriggerVolume(const TriggerVolume &volume, const edyn::AABB &aabb) {
+    if (!volume.exact) {
+        return true;
+    }
+
+    switch (volume.shape) {
+    case TriggerShape::Box:
+        return IntersectBoxAABB(volume, aabb);
+    case TriggerShape::Sphere:
+        return IntersectSphereAABB(volume, aabb);
+    }
+
+    return true;
+}
+
+// Emits enter events for bodies in `curr` but not in `prev` and exit events
+// for bodies in `prev` but not in `curr`. Both must be sorted.
+static void DiffOverlaps(entt::entity trigger,
+                         const entt::entity *prev, const entt::entity *prev_end,
+                         const entt::entity *curr, const entt::entity *curr_end,
+                         std::vector<TriggerEvent> &events) {
+    while (prev != prev_end || curr != curr_end) {
+        if (curr == curr_end || (prev != prev_end && *prev < *curr)) {
+            events.push_back({TriggerEventType::Exit, trigger, *prev++});
+        } else if (prev == prev_end || *curr < *prev) {
+            events.push_back({TriggerEventType::Enter, trigger, *curr++});
+        } else {
+            ++prev;
+            ++curr;
+        }
+    }
+}
+
+void UpdateTriggerVolumes(entt::registry &registry, TriggerEventDelegate delegate) {
+    auto *ctx = registry.ctx().find<TriggerVolumeContext>();
+
+    if (ctx == nullptr) {
+        ctx = &registry.ctx().emplace<TriggerVolumeContext>();
+    }
+
+    std::swap(ctx->previous, ctx->current);
+    ctx->current.clear();
+    ctx->items.clear();
+    ctx->body_entities.clear();
+    ctx->pairs.clear();
+    ctx->events.clear();
+
+    auto trigger_view = registry.view<TriggerVolume>();
+    auto body_view = registry.view<edyn::AABB>(entt::exclude<edyn::static_tag>);
+
+    for (auto [entity, volume] : trigger_view.each()) {
+        auto index = static_cast<uint32_t>(ctx->current.triggers.size());
+        ctx->current.triggers.push_back(entity);
+        ctx->items.push_back({GetTriggerVolumeAABB(volume), index, true});
+    }
+
+    for (auto [entity, aabb] : body_view.each()) {
+        auto index = static_cast<uint32_t>(ctx->body_entities.size());
+        ctx->body_entities.push_back(entity);
+        ctx->items.push_back({aabb, index, false});
+    }
+
+    // Sweep along the x axis. Items are only tested against the active items
+    // of the other kind, since triggers don't report other triggers and
+    // bodies are already handled by the broadphase.
+    std::sort(ctx->items.begin(), ctx->items.end(), [](auto &a, auto &b) {
+        return a.aabb.min.x < b.aabb.min.x;
+    });
+
+    ctx->active_triggers.clear();
+    ctx->active_bodies.clear();
+
+    auto prune = [&](std::vector<uint32_t> &active, edyn::scalar min_x) {
+        active.erase(std::remove_if(active.begin(), active.end(), [&](uint32_t item_idx) {
+            return ctx->items[item_idx].aabb.max.x < min_x;
+        }), active.end());
+    };
+
+    auto overlap_yz = [](const edyn::AABB &a, const edyn::AABB &b) {
+        return a.min.y <= b.max.y && a.max.y >= b.min.y &&
+               a.min.z <= b.max.z && a.max.z >= b.min.z;
+    };
+
+    for (uint32_t i = 0; i < ctx->items.size(); ++i) {
+        auto &item = ctx->items[i];
+        auto &others = item.is_trigger ? ctx->active_bodies : ctx->active_triggers;
+        prune(others, item.aabb.min.x);
+
+        for (auto other_idx : others) {
+            auto &other = ctx->items[other_idx];
+
+            if (!overlap_yz(item.aabb, other.aabb)) {
+                continue;
+            }
+
+            auto &trigger_item = item.is_trigger ? item : other;
+            auto &body_item = item.is_trigger ? other : item;
+            auto trigger_entity = ctx->current.triggers[trigger_item.index];
+            auto &volume = trigger_view.get<TriggerVolume>(trigger_entity);
+
+            if (IntersectTriggerVolume(volume, body_item.aabb)) {
+                ctx->pairs.push_back({trigger_item.index, ctx->body_entities[body_item.index]});
+            }
+        }
+
+        (item.is_trigger ? ctx->active_triggers : ctx->active_bodies).push_back(i);
+    }
+
+    // Group overlapping bodies by trigger.
+    std::sort(ctx->pairs.begin(), ctx->pairs.end());
+
+    auto &current = ctx->current;
+    auto num_triggers = current.triggers.size();
+    current.offsets.assign(num_triggers + 1, 0);
+    current.bodies.reserve(ctx->pairs.size());
+
+    for (auto &pair : ctx->pairs) {
+        ++current.offsets[pair.trigger_index + 1];
+        current.bodies.push_back(pair.body);
+    }
+
+    for (size_t i = 0; i < num_triggers; ++i) {
+        current.offsets[i + 1] += current.offsets[i];
+    }
+
+    // Triggers are matched with their previous overlaps by entity since
+    // indices change as triggers are created and destroyed.
+    std::swap(ctx->trigger_index, ctx->prev_trigger_index);
+    ctx->trigger_index.clear();
+    auto &prev_index = ctx->prev_trigger_index;
+
+    for (uint32_t i = 0; i < num_triggers; ++i) {
+        auto trigger = current.triggers[i];
+        ctx->trigger_index[trigger] = i;
+
+        auto *curr_begin = current.bodies.data() + current.offsets[i];
+        auto *curr_end = current.bodies.data() + current.offsets[i + 1];
+        const entt::entity *prev_begin = nullptr, *prev_end = nullptr;
+
+        if (auto it = prev_index.find(trigger); it != prev_index.end()) {
+            prev_begin = ctx->previous.bodies.data() + ctx->previous.offsets[it->second];
+            prev_end = ctx->previous.bodies.data() + ctx->previous.offsets[it->second + 1];
+        }
+
+        DiffOverlaps(trigger, prev_begin, prev_end, curr_begin, curr_end, ctx->events);
+    }
+
+    // Bodies that were in triggers destroyed since the last update exit them.
+    auto &previous = ctx->previous;
+
+    for (uint32_t i = 0; i < previous.triggers.size(); ++i) {
+        auto trigger = previous.triggers[i];
+
+        if (ctx->trigger_index.count(trigger)) {
+            continue;
+        }
+
+        auto *prev_begin = previous.bodies.data() + previous.offsets[i];
+        auto *prev_end = previous.bodies.data() + previous.offsets[i + 1];
+        DiffOverlaps(trigger, prev_begin, prev_end, nullptr, nullptr, ctx->events);
+    }
+
+    if (delegate && !ctx->events.empty()) {
+        delegate(ctx->events.data(), ctx->events.size());
+    }
+}
+
+TriggerOverlaps GetTriggerOverlaps(entt::registry &registry, entt::entity trigger) {
+    auto *ctx = registry.ctx().find<TriggerVolumeContext>();
+
+    if (ctx == nullptr) {
+        return {};
+    }
+
+    auto it = ctx->trigger_index.find(trigger);
+
+    if (it == ctx->trigger_index.end()) {
+        return {};
+    }
+
+    auto &current = ctx->current;
+    auto begin = current.offsets[it->second];
+    auto end = current.offsets[it->second + 1];
+    return {current.bodies.data() + begin, end - begin};
+}
@@ -0,0 +1,182 @@
+#include "vehicle_system.hpp"
+#include <edyn/context/task.hpp>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+// Traction control and ABS for `count` wheels. The arrays are passed as
+// non-aliasing pointers, the loop body is branchless and speeds are compared
+// squared which avoids `std::sqrt` and its errno side effect, so the compiler
+// is able to vectorize it across wheels.
+static void ComputeWheelTorques(size_t count, edyn::scalar dt,
+                                const edyn::scalar *__restrict axis_x,
+                                const edyn::scalar *__restrict axis_y,
+                                const edyn::scalar *__restrict axis_z,
+                                const edyn::scalar *__restrict linvel_x,
+                                const edyn::scalar *__restrict linvel_y,
+                                const edyn::scalar *__restrict linvel_z,
+                                const edyn::scalar *__restrict angvel_x,
+                                const edyn::scalar *__restrict angvel_y,
+                                const edyn::scalar *__restrict angvel_z,
+                                const edyn::scalar *__restrict throttle,
+                                const edyn::scalar *__restrict brakes,
+                                const edyn::scalar *__restrict driving_torque,
+                                const edyn::scalar *__restrict brake_torque,
+                                const edyn::scalar *__restrict bearing_torque,
+                                edyn::scalar *__restrict torque_impulse,
+                                edyn::scalar *__restrict friction_torque) {
+    const auto abs_min_speed_sq = edyn::scalar(2 * 2);
+    const auto abs_max_spin = edyn::to_radians(1);
+
+    for (size_t i = 0; i < count; ++i) {
+        auto spin_speed = angvel_x[i] * axis_x[i] + angvel_y[i] * axis_y[i] + angvel_z[i] * axis_z[i];
+        auto linvel_proj = linvel_x[i] * axis_x[i] + linvel_y[i] * axis_y[i] + linvel_z[i] * axis_z[i];
+        auto long_x = linvel_x[i] - axis_x[i] * linvel_proj;
+        auto long_y = linvel_y[i] - axis_y[i] * linvel_proj;
+        auto long_z = linvel_z[i] - axis_z[i] * linvel_proj;
+        auto longitudinal_speed_sq = long_x * long_x + long_y * long_y + long_z * long_z;
+        auto abs_spin_speed = std::abs(spin_speed);
+        auto quarter_spin_speed = abs_spin_speed * edyn::scalar(0.25);
+
+        // Rudimentary traction control.
+        auto slipping = quarter_spin_speed * quarter_spin_speed > longitudinal_speed_sq;
+        auto wheel_throttle = std::max(throttle[i], edyn::scalar(0));
+        wheel_throttle = slipping ? edyn::scalar(0) : wheel_throttle;
+        torque_impulse[i] = wheel_throttle * driving_torque[i] * dt;
+
+        // Rudimentary ABS.
+        auto locked = (longitudinal_speed_sq > abs_min_speed_sq) & (abs_spin_speed < abs_max_spin);
+        auto wheel_brakes = brakes[i];
+        wheel_brakes = locked ? edyn::scalar(0) : wheel_brakes;
+        friction_torque[i] = wheel_brakes * brake_torque[i] + bearing_torque[i];
+    }
+}
+
+// Wheel state of all awake vehicles in structure-of-arrays layout. Kept in
+// the registry context so the buffers are reused every step.
+struct VehicleWheelBatch {
+    // Minimum number of wheels before the computation is split among the
+    // workers of the task scheduler.
+    static constexpr size_t parallel_threshold = 512;
+
+    std::vector<entt::entity> vehicle_entities;
+    std::vector<entt::entity> wheel_entities;
+    std::vector<entt::entity> suspension_entities;
+
+    // Inputs.
+    std::vector<edyn::scalar> axis_x, axis_y, axis_z;
+    std::vector<edyn::scalar> linvel_x, linvel_y, linvel_z;
+    std::vector<edyn::scalar> angvel_x, angvel_y, angvel_z;
+    std::vector<edyn::scalar> throttle, brakes;
+    std::vector<edyn::scalar> driving_torque, brake_torque, bearing_torque;
+
+    // Outputs.
+    std::vector<edyn::scalar> torque_impulse;
+    std::vector<edyn::scalar> friction_torque;
+
+    edyn::scalar dt;
+
+    void clear() {
+        vehicle_entities.clear();
+        wheel_entities.clear();
+        suspension_entities.clear();
+        axis_x.clear(); axis_y.clear(); axis_z.clear();
+        linvel_x.clear(); linvel_y.clear(); linvel_z.clear();
+        angvel_x.clear(); angvel_y.clear(); angvel_z.clear();
+        throttle.clear(); brakes.clear();
+        driving_torque.clear(); brake_torque.clear(); bearing_torque.clear();
+    }
+
+    void pushWheel(entt::entity wheel_entity, entt::entity suspension_entity,
+                   const edyn::vector3 &axis, const edyn::vector3 &linvel, const edyn::vector3 &angvel,
+                   const VehicleSettings &settings, const VehicleState &state) {
+        wheel_entities.push_back(wheel_entity);
+        suspension_entities.push_back(suspension_entity);
+        axis_x.push_back(axis.x); axis_y.push_back(axis.y); axis_z.push_back(axis.z);
+        linvel_x.push_back(linvel.x); linvel_y.push_back(linvel.y); linvel_z.push_back(linvel.z);
+        angvel_x.push_back(angvel.x); angvel_y.push_back(angvel.y); angvel_z.push_back(angvel.z);
+        throttle.push_back(state.throttle);
+        brakes.push_back(state.brakes);
+        driving_torque.push_back(settings.driving_torque);
+        brake_torque.push_back(settings.brake_torque);
+        bearing_torque.push_back(settings.bearing_torque);
+    }
+
+    // Computes traction control and ABS for wheels in [start, end).
+    void compute(unsigned start, unsigned end) {
+        ComputeWheelTorques(end - start, dt,
+                            axis_x.data() + start, axis_y.data() + start, axis_z.data() + start,
+                            linvel_x.data() + start, linvel_y.data() + start, linvel_z.data() + start,
+                            angvel_x.data() + start, angvel_y.data() + start, angvel_z.data() + start,
+                            throttle.data() + start, brakes.data() + start,
+                            driving_torque.data() + start, brake_torque.data() + start, bearing_torque.data() + start,
+                            torque_impulse.data() + start, friction_torque.data() + start);
+    }
+};
+
+static void GatherVehicles(entt::registry &registry, VehicleWheelBatch &batch) {
+    auto vehicle_view = registry.view<const Vehicle, const VehicleSettings, VehicleState>(edyn::exclude_sleeping_disabled);
+    auto wheel_view = registry.view<const edyn::linvel, const edyn::angvel, const edyn::orientation>();
+
+    for (auto [entity, vehicle, settings, state] : vehicle_view.each()) {
+        ApplySteering(registry, vehicle, settings, state, batch.dt);
+        batch.vehicle_entities.push_back(entity);
+
+        for (int i = 0; i < 4; ++i) {
+            auto [wheel_linvel, wheel_angvel, wheel_orn] = wheel_view.get(vehicle.wheel_entity[i]);
+            auto spin_axis = edyn::quaternion_x(wheel_orn);
+            batch.pushWheel(vehicle.wheel_entity[i], vehicle.suspension_entity[i],
+                            spin_axis, wheel_linvel, wheel_angvel, settings, state);
+        }
+    }
+
+    auto num_wheels = batch.wheel_entities.size();
+    batch.torque_impulse.resize(num_wheels);
+    batch.friction_torque.resize(num_wheels);
+}
+
+static void ScatterVehicles(entt::registry &registry, VehicleWheelBatch &batch) {
+    auto con_view = registry.view<edyn::generic_constraint>();
+
+    for (size_t i = 0; i < batch.wheel_entities.size(); ++i) {
+        if (batch.torque_impulse[i] > 0) {
+            auto spin_axis = edyn::vector3{batch.axis_x[i], batch.axis_y[i], batch.axis_z[i]};
+            edyn::rigidbody_apply_torque_impulse(registry, batch.wheel_entities[i], spin_axis * batch.torque_impulse[i]);
+        }
+
+        auto &con = con_view.get<edyn::generic_constraint>(batch.suspension_entities[i]);
+        con.angular_dofs[0].friction_torque = batch.friction_torque[i];
+    }
+
+    for (auto entity : batch.vehicle_entities) {
+        registry.patch<VehicleState>(entity);
+    }
+}
+
+void UpdateVehiclesBatched(entt::registry &registry) {
+    ProcessVehicleActions(registry);
+
+    auto *batch = registry.ctx().find<VehicleWheelBatch>();
+
+    if (batch == nullptr) {
+        batch = &registry.ctx().emplace<VehicleWheelBatch>();
+    }
+
+    batch->clear();
+    batch->dt = edyn::get_fixed_dt(registry);
+
+    GatherVehicles(registry, *batch);
+
+    auto num_wheels = static_cast<unsigned>(batch->wheel_entities.size());
+
+    if (num_wheels >= VehicleWheelBatch::parallel_threshold) {
+        // The computation only reads and writes the batch arrays thus it's
+        // safe to run it concurrently with no access to the registry.
+        auto task = edyn::task_delegate_t(entt::connect_arg_t<&VehicleWheelBatch::compute>{}, *batch);
+        auto enqueue_task_wait = edyn::get_enqueue_task_wait(registry);
+        enqueue_task_wait(task, num_wheels);
+    } else {
+        batch->compute(0, num_wheels);
+    }
+
+    ScatterVehicles(registry, *batch);
+}
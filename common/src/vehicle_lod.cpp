@@ -0,0 +1,149 @@
+#include "vehicle_lod.hpp"
+#include "vehicle_system.hpp"
+#include "raycast_vehicle_system.hpp"
+#include <algorithm>
+#include <limits>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+void MakeVehicleLOD(entt::registry &registry, entt::entity vehicle_entity) {
+    auto &vehicle = registry.get<Vehicle>(vehicle_entity);
+    auto lod = VehicleLOD{};
+    lod.last_change_time = edyn::performance_time();
+    lod.null_con_entity = vehicle.null_con_entity;
+    registry.emplace<VehicleLOD>(vehicle_entity, lod);
+}
+
+static edyn::scalar DistanceSqrToRegions(const std::vector<edyn::AABB> &regions, const edyn::vector3 &point) {
+    auto min_dist_sqr = std::numeric_limits<edyn::scalar>::max();
+
+    for (auto &aabb : regions) {
+        auto closest = edyn::min(edyn::max(point, aabb.min), aabb.max);
+        min_dist_sqr = std::min(min_dist_sqr, edyn::distance_sqr(point, closest));
+    }
+
+    return min_dist_sqr;
+}
+
+static void SimplifyVehicle(entt::registry &registry, entt::entity vehicle_entity) {
+    auto vehicle = registry.get<Vehicle>(vehicle_entity);
+    auto &pos = registry.get<edyn::position>(vehicle.chassis_entity);
+    auto &orn = registry.get<edyn::orientation>(vehicle.chassis_entity);
+    auto &angvel = registry.get<edyn::angvel>(vehicle.chassis_entity);
+
+    MakeRaycastVehicle(registry, vehicle_entity, vehicle.chassis_entity);
+    auto &rc_settings = registry.get<RaycastVehicleSettings>(vehicle_entity);
+
+    registry.patch<RaycastVehicle>(vehicle_entity, [&](RaycastVehicle &rc_vehicle) {
+        for (int i = 0; i < 4; ++i) {
+            auto wheel_entity = vehicle.wheel_entity[i];
+            auto &wheel_pos = registry.get<edyn::position>(wheel_entity);
+            auto &wheel_orn = registry.get<edyn::orientation>(wheel_entity);
+            auto &wheel_angvel = registry.get<edyn::angvel>(wheel_entity);
+
+            // The wheel hangs below its mount point along the chassis up axis.
+            auto local_pos = edyn::to_object_space(wheel_pos, pos, orn);
+            rc_vehicle.suspension_length[i] = std::clamp(rc_settings.mount_position[i].y - local_pos.y,
+                                                         edyn::scalar(0), rc_settings.max_length);
+            rc_vehicle.spin_speed[i] = edyn::dot(wheel_angvel - angvel, edyn::quaternion_x(wheel_orn));
+        }
+    });
+
+    DestroyVehicleWheels(registry, vehicle);
+    registry.remove<Vehicle>(vehicle_entity);
+}
+
+static void RestoreVehicle(entt::registry &registry, entt::entity vehicle_entity, entt::entity null_con_entity) {
+    auto &rc_vehicle = registry.get<RaycastVehicle>(vehicle_entity);
+    auto &rc_settings = registry.get<RaycastVehicleSettings>(vehicle_entity);
+    auto &settings = registry.get<VehicleSettings>(vehicle_entity);
+    auto &state = registry.get<VehicleState>(vehicle_entity);
+
+    auto chassis_entity = rc_vehicle.chassis_entity;
+    auto &pos = registry.get<edyn::position>(chassis_entity);
+    auto &orn = registry.get<edyn::orientation>(chassis_entity);
+    auto &linvel = registry.get<edyn::linvel>(chassis_entity);
+    auto &angvel = registry.get<edyn::angvel>(chassis_entity);
+
+    auto wheels = std::array<VehicleWheelState, 4>{};
+
+    for (int i = 0; i < 4; ++i) {
+        auto local_pos = rc_settings.mount_position[i] - edyn::vector3{0, rc_vehicle.suspension_length[i], 0};
+        auto &wheel = wheels[i];
+        wheel.position = edyn::to_world_space(local_pos, pos, orn);
+        wheel.orientation = orn *
+            edyn::quaternion_axis_angle({0, 1, 0}, GetWheelSteering(state, i)) *
+            edyn::quaternion_axis_angle({1, 0, 0}, rc_vehicle.spin_angle[i]);
+        wheel.linvel = linvel + edyn::cross(angvel, wheel.position - pos);
+        wheel.angvel = angvel + edyn::quaternion_x(wheel.orientation) * rc_vehicle.spin_speed[i];
+    }
+
+    auto vehicle = Vehicle{};
+    vehicle.chassis_entity = chassis_entity;
+    vehicle.null_con_entity = null_con_entity;
+    CreateVehicleWheels(registry, vehicle, settings, wheels);
+
+    registry.remove<RaycastVehicle>(vehicle_entity);
+    registry.emplace<Vehicle>(vehicle_entity, vehicle);
+}
+
+void UpdateVehicleLOD(entt::registry &registry, const std::vector<edyn::AABB> &regions,
+                      const VehicleLODSettings &settings) {
+    struct Migration {
+        entt::entity entity;
+        edyn::scalar distance_sqr;
+        VehicleLODLevel level;
+    };
+
+    auto time = edyn::performance_time();
+    auto full_dist_sqr = edyn::square(settings.full_distance);
+    auto simplified_dist_sqr = edyn::square(settings.simplified_distance);
+    auto migrations = std::vector<Migration>{};
+
+    for (auto [entity, lod] : registry.view<VehicleLOD>().each()) {
+        if (time - lod.last_change_time < settings.min_dwell_time) {
+            continue;
+        }
+
+        auto chassis_entity = lod.level == VehicleLODLevel::Full ?
+            registry.get<Vehicle>(entity).chassis_entity :
+            registry.get<RaycastVehicle>(entity).chassis_entity;
+        auto &pos = registry.get<edyn::position>(chassis_entity);
+        auto dist_sqr = DistanceSqrToRegions(regions, pos);
+
+        if (lod.level == VehicleLODLevel::Full && dist_sqr > simplified_dist_sqr) {
+            migrations.push_back({entity, dist_sqr, VehicleLODLevel::Simplified});
+        } else if (lod.level == VehicleLODLevel::Simplified && dist_sqr < full_dist_sqr) {
+            migrations.push_back({entity, dist_sqr, VehicleLODLevel::Full});
+        }
+    }
+
+    // Restore the closest vehicles first since they're the most likely to
+    // be seen, then simplify the farthest.
+    std::sort(migrations.begin(), migrations.end(), [](const Migration &a, const Migration &b) {
+        if (a.level != b.level) {
+            return a.level == VehicleLODLevel::Full;
+        }
+
+        return a.level == VehicleLODLevel::Full ?
+            a.distance_sqr < b.distance_sqr : a.distance_sqr > b.distance_sqr;
+    });
+
+    if (migrations.size() > settings.max_migrations_per_update) {
+        migrations.resize(settings.max_migrations_per_update);
+    }
+
+    for (auto &migration : migrations) {
+        auto &lod = registry.get<VehicleLOD>(migration.entity);
+
+        if (migration.level == VehicleLODLevel::Simplified) {
+            SimplifyVehicle(registry, migration.entity);
+        } else {
+            RestoreVehicle(registry, migration.entity, lod.null_con_entity);
+        }
+
+        lod.level = migration.level;
+        lod.last_change_time = time;
+        edyn::wake_up_entity(registry, migration.entity);
+    }
+}
@@ -0,0 +1,160 @@
+#include "vehicle_system.hpp"
+#include <utility>
+#include <edyn/context/task.hpp>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+
+// Registry writes recorded by one partition of vehicles, to be applied
+// serially once all partitions are done.
+struct VehicleCommandBuffer {
+    struct FrameCommand {
+        entt::entity suspension_entity;
+        edyn::matrix3x3 frame;
+    };
+
+    struct WheelCommand {
+        entt::entity wheel_entity;
+        entt::entity suspension_entity;
+        WheelControl control;
+    };
+
+    struct StateCommand {
+        entt::entity vehicle_entity;
+        VehicleState state;
+    };
+
+    std::vector<FrameCommand> frames;
+    std::vector<WheelCommand> wheels;
+    std::vector<StateCommand> states;
+
+    void clear() {
+        frames.clear();
+        wheels.clear();
+        states.clear();
+    }
+};
+
+// Views read by the workers, created on the calling thread before work is
+// dispatched so workers never touch the registry.
+struct VehicleReadViews {
+    using vehicle_view_t = decltype(std::declval<entt::registry &>().view<const Vehicle, const VehicleSettings, const VehicleState>());
+    using wheel_view_t = decltype(std::declval<entt::registry &>().view<const edyn::linvel, const edyn::angvel, const edyn::orientation>());
+
+    vehicle_view_t vehicle_view;
+    wheel_view_t wheel_view;
+
+    VehicleReadViews(entt::registry &registry)
+        : vehicle_view(registry.view<const Vehicle, const VehicleSettings, const VehicleState>())
+        , wheel_view(registry.view<const edyn::linvel, const edyn::angvel, const edyn::orientation>())
+    {}
+};
+
+struct VehicleParallelContext {
+    // Number of vehicles assigned to each partition. Small enough to balance
+    // the load, large enough to amortize the dispatch.
+    static constexpr size_t vehicles_per_partition = 16;
+
+    entt::registry *registry;
+    const VehicleReadViews *views;
+    edyn::scalar dt;
+    std::vector<entt::entity> vehicle_entities;
+    std::vector<VehicleCommandBuffer> buffers;
+
+    // Computes the partitions in [start, end). Only reads through `views`.
+    void compute(unsigned start, unsigned end) {
+        auto &vehicle_view = views->vehicle_view;
+        auto &wheel_view = views->wheel_view;
+
+        for (auto p = start; p < end; ++p) {
+            auto &buffer = buffers[p];
+            buffer.clear();
+
+            auto first = p * vehicles_per_partition;
+            auto last = std::min(first + vehicles_per_partition, vehicle_entities.size());
+
+            for (auto i = first; i < last; ++i) {
+                auto entity = vehicle_entities[i];
+                auto [vehicle, settings, current_state] = vehicle_view.get(entity);
+                auto state = current_state;
+
+                auto frames = UpdateSteering(settings, state, dt);
+
+                for (int j = 0; j < 2; ++j) {
+                    buffer.frames.push_back({vehicle.suspension_entity[j], frames[j]});
+                }
+
+                for (int j = 0; j < 4; ++j) {
+                    auto [wheel_linvel, wheel_angvel, wheel_orn] = wheel_view.get(vehicle.wheel_entity[j]);
+                    auto control = ComputeWheelControl(settings, state, wheel_linvel, wheel_angvel, wheel_orn, dt);
+                    buffer.wheels.push_back({vehicle.wheel_entity[j], vehicle.suspension_entity[j], control});
+                }
+
+                buffer.states.push_back({entity, state});
+            }
+        }
+    }
+
+    void apply() {
+        auto con_view = registry->view<edyn::generic_constraint>();
+
+        // Apply in partition order so the result doesn't depend on how the
+        // partitions were scheduled.
+        for (auto &buffer : buffers) {
+            for (auto &cmd : buffer.frames) {
+                con_view.get<edyn::generic_constraint>(cmd.suspension_entity).frame[0] = cmd.frame;
+            }
+
+            for (auto &cmd : buffer.wheels) {
+                if (cmd.control.torque_impulse != edyn::vector3_zero) {
+                    edyn::rigidbody_apply_torque_impulse(*registry, cmd.wheel_entity, cmd.control.torque_impulse);
+                }
+
+                auto &con = con_view.get<edyn::generic_constraint>(cmd.suspension_entity);
+                con.angular_dofs[0].friction_torque = cmd.control.friction_torque;
+            }
+
+            for (auto &cmd : buffer.states) {
+                registry->replace<VehicleState>(cmd.vehicle_entity, cmd.state);
+            }
+        }
+    }
+};
+
+void UpdateVehiclesParallel(entt::registry &registry) {
+    ProcessVehicleActions(registry);
+
+    auto *ctx = registry.ctx().find<VehicleParallelContext>();
+
+    if (ctx == nullptr) {
+        ctx = &registry.ctx().emplace<VehicleParallelContext>();
+    }
+
+    ctx->registry = &registry;
+    ctx->dt = edyn::get_fixed_dt(registry);
+    ctx->vehicle_entities.clear();
+
+    auto vehicle_view = registry.view<const Vehicle, const VehicleSettings, VehicleState>(edyn::exclude_sleeping_disabled);
+
+    for (auto entity : vehicle_view) {
+        ctx->vehicle_entities.push_back(entity);
+    }
+
+    auto num_vehicles = ctx->vehicle_entities.size();
+    auto num_partitions = (num_vehicles + VehicleParallelContext::vehicles_per_partition - 1) /
+                          VehicleParallelContext::vehicles_per_partition;
+    ctx->buffers.resize(num_partitions);
+
+    auto views = VehicleReadViews(registry);
+    ctx->views = &views;
+
+    if (num_partitions > 1) {
+        auto task = edyn::task_delegate_t(entt::connect_arg_t<&VehicleParallelContext::compute>{}, *ctx);
+        auto enqueue_task_wait = edyn::get_enqueue_task_wait(registry);
+        enqueue_task_wait(task, static_cast<unsigned>(num_partitions));
+    } else {
+        ctx->compute(0, static_cast<unsigned>(num_partitions));
+    }
+
+    ctx->views = nullptr;
+    ctx->apply();
+}
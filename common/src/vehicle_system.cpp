@@ -1,4 +1,5 @@
 #include "vehicle_system.hpp"
+#include "raycast_vehicle_system.hpp"
 #include "pick_input.hpp"
 #include <edyn/comp/tag.hpp>
 #include <edyn/networking/comp/asset_ref.hpp>
@@ -17,19 +18,26 @@ void RegisterVehicleComponents(entt::registry &registry) {
         .data<&Vehicle::null_con_entity, entt::as_ref_t>("null_con_entity"_hs)
         .data<&Vehicle::suspension_entity, entt::as_ref_t>("suspension_entity"_hs)
         .data<&Vehicle::wheel_entity, entt::as_ref_t>("wheel_entity"_hs);
+    entt::meta_factory<RaycastVehicle>()
+        .data<&RaycastVehicle::chassis_entity, entt::as_ref_t>("chassis_entity"_hs);
     auto actions = std::tuple<VehicleAction>{};
-    edyn::register_external_components<PickInput, Vehicle, VehicleSettings, VehicleState>(registry, actions);
+    edyn::register_external_components<
+        PickInput,
+        Vehicle, VehicleSettings, VehicleState,
+        RaycastVehicle, RaycastVehicleSettings
+    >(registry, actions);
 }
 
 void RegisterNetworkedVehicleComponents(entt::registry &registry) {
     auto actions = std::tuple<VehicleAction>{};
     edyn::register_networked_components<
         PickInput,
-        VehicleState
+        VehicleState,
+        RaycastVehicle, RaycastVehicleSettings
     >(registry, actions);
 }
 
-entt::entity CreateVehicle(entt::registry &registry) {
+entt::entity CreateVehicle(entt::registry &registry, edyn::vector3 position) {
     auto vehicle_entity = registry.create();
     edyn::tag_external_entity(registry, vehicle_entity);
 
@@ -44,7 +52,7 @@ entt::entity CreateVehicle(entt::registry &registry) {
     chassis_def.material->friction = 0.3;
     chassis_def.mass = 600;
     chassis_def.shape = edyn::box_shape{0.65, 0.5, 1.85};
-    chassis_def.position = {0, 2, 0};
+    chassis_def.position = position;
     auto chassis_entity = edyn::make_rigidbody(registry, chassis_def);
 
     auto vehicle = Vehicle{};
@@ -55,6 +63,23 @@ entt::entity CreateVehicle(entt::registry &registry) {
     vehicle.null_con_entity = edyn::make_constraint<edyn::null_constraint>(registry, vehicle_entity, chassis_entity);
 
     // Wheels.
+    auto wheels = std::array<VehicleWheelState, 4>{};
+
+    for (int i = 0; i < 4; ++i) {
+        auto lateral = i == 0 || i == 2 ? 1 : -1;
+        auto longitudinal = i == 0 || i == 1 ? 1 : -1;
+        wheels[i].position = position + edyn::vector3{lateral * 0.9f, -0.5f, longitudinal * 1.45f};
+    }
+
+    CreateVehicleWheels(registry, vehicle, settings, wheels);
+
+    registry.emplace<Vehicle>(vehicle_entity, vehicle);
+
+    return vehicle_entity;
+}
+
+void CreateVehicleWheels(entt::registry &registry, Vehicle &vehicle, const VehicleSettings &settings,
+                         const std::array<VehicleWheelState, 4> &wheels) {
     auto wheel_def = edyn::rigidbody_def{};
     wheel_def.material->restitution = 0.6;
     wheel_def.material->friction = 1;
@@ -67,11 +92,14 @@ entt::entity CreateVehicle(entt::registry &registry) {
     for (int i = 0; i < 4; ++i) {
         auto lateral = i == 0 || i == 2 ? 1 : -1;
         auto longitudinal = i == 0 || i == 1 ? 1 : -1;
-        wheel_def.position = {lateral * 0.9f, 1.5, longitudinal * 1.45f};
+        wheel_def.position = wheels[i].position;
+        wheel_def.orientation = wheels[i].orientation;
+        wheel_def.linvel = wheels[i].linvel;
+        wheel_def.angvel = wheels[i].angvel;
         auto wheel_entity = edyn::make_rigidbody(registry, wheel_def);
-        edyn::exclude_collision(registry, chassis_entity, wheel_entity);
+        edyn::exclude_collision(registry, vehicle.chassis_entity, wheel_entity);
 
-        auto con_ent = edyn::make_constraint<edyn::generic_constraint>(registry, chassis_entity, wheel_entity,
+        auto con_ent = edyn::make_constraint<edyn::generic_constraint>(registry, vehicle.chassis_entity, wheel_entity,
             [&](edyn::generic_constraint &con) {
                 con.frame[0] = edyn::to_matrix3x3(
                     edyn::quaternion_axis_angle({0, 0, 1}, edyn::to_radians(settings.camber * -lateral)));
@@ -92,10 +120,15 @@ entt::entity CreateVehicle(entt::registry &registry) {
         vehicle.wheel_entity[i] = wheel_entity;
         vehicle.suspension_entity[i] = con_ent;
     }
+}
 
-    registry.emplace<Vehicle>(vehicle_entity, vehicle);
-
-    return vehicle_entity;
+void DestroyVehicleWheels(entt::registry &registry, Vehicle &vehicle) {
+    for (int i = 0; i < 4; ++i) {
+        registry.destroy(vehicle.suspension_entity[i]);
+        registry.destroy(vehicle.wheel_entity[i]);
+        vehicle.suspension_entity[i] = entt::null;
+        vehicle.wheel_entity[i] = entt::null;
+    }
 }
 
 entt::entity MakeVehicleNetworked(entt::registry &registry, entt::entity vehicle_entity) {
@@ -149,7 +182,7 @@ void ExecuteAction(entt::registry &registry, entt::entity entity, const VehicleB
         });
 }
 
-void ProcessActions(entt::registry &registry) {
+void ProcessVehicleActions(entt::registry &registry) {
     auto sleeping_view = registry.view<edyn::sleeping_tag>();
 
     for (auto [entity, list] : registry.view<VehicleActionList>().each()) {
@@ -167,93 +200,116 @@ void ProcessActions(entt::registry &registry) {
     }
 }
 
-void ApplySteering(entt::registry &registry, const Vehicle &vehicle,
-                   const VehicleSettings &settings, VehicleState &state, edyn::scalar dt) {
+void AdvanceSteering(const VehicleSettings &settings, VehicleState &state, edyn::scalar dt) {
     auto steering_direction = state.target_steering > state.steering ? 1 : -1;
     auto steering_increment = std::min(settings.max_steering_rate * dt, std::abs(state.target_steering - state.steering)) * steering_direction;
     state.steering += steering_increment;
+}
+
+edyn::scalar GetWheelSteering(const VehicleState &state, int wheel_index) {
+    if (wheel_index > 1) {
+        return 0;
+    }
+
+    auto steering = state.steering;
+
+    // Slight Ackerman effect.
+    if ((wheel_index == 0 && steering > 0) || (wheel_index == 1 && steering < 0)) {
+        steering *= 1.1;
+    }
+
+    return steering;
+}
+
+std::array<edyn::matrix3x3, 2> UpdateSteering(const VehicleSettings &settings, VehicleState &state, edyn::scalar dt) {
+    AdvanceSteering(settings, state, dt);
+
+    auto frames = std::array<edyn::matrix3x3, 2>{};
 
     for (int i = 0; i < 2; ++i) {
-        auto steering = state.steering;
+        frames[i] = edyn::to_matrix3x3(
+            edyn::quaternion_axis_angle({0, 0, 1}, edyn::to_radians(settings.camber * (i == 0 ? -1 : 1))) *
+            edyn::quaternion_axis_angle({0, 1, 0}, GetWheelSteering(state, i)));
+    }
 
-        // Slight Ackerman effect.
-        if ((i == 0 && steering > 0) || (i == 1 && steering < 0)) {
-            steering *= 1.1;
-        }
+    return frames;
+}
 
+void ApplySteering(entt::registry &registry, const Vehicle &vehicle,
+                   const VehicleSettings &settings, VehicleState &state, edyn::scalar dt) {
+    auto frames = UpdateSteering(settings, state, dt);
+
+    for (int i = 0; i < 2; ++i) {
         auto &con = registry.get<edyn::generic_constraint>(vehicle.suspension_entity[i]);
-        con.frame[0] = edyn::to_matrix3x3(
-            edyn::quaternion_axis_angle({0, 0, 1}, edyn::to_radians(settings.camber * (i == 0 ? -1 : 1))) *
-            edyn::quaternion_axis_angle({0, 1, 0}, steering));
+        con.frame[0] = frames[i];
     }
 }
 
-void ApplyThrottle(entt::registry &registry, const Vehicle &vehicle,
-                   const VehicleSettings &settings, const VehicleState &state, edyn::scalar dt) {
-    for (int i = 0; i < 4; ++i) {
-        auto wheel_entity = vehicle.wheel_entity[i];
-        auto &wheel_linvel = registry.get<edyn::linvel>(wheel_entity);
-        auto &wheel_angvel = registry.get<edyn::angvel>(wheel_entity);
-        auto &wheel_orn = registry.get<edyn::orientation>(wheel_entity);
-        auto spin_axis = edyn::quaternion_x(wheel_orn);
-        auto spin_speed = edyn::dot(wheel_angvel, spin_axis);
-        auto longitudinal_speed = edyn::length(edyn::project_direction(wheel_linvel, spin_axis));
-        edyn::scalar throttle;
-
-        // Rudimentary traction control.
-        if (std::abs(spin_speed) * 0.25f > longitudinal_speed) {
-            throttle = 0;
-        } else {
-            throttle = state.throttle;
-        }
+WheelControl ComputeWheelControl(const VehicleSettings &settings, const VehicleState &state,
+                                 const edyn::vector3 &wheel_linvel, const edyn::vector3 &wheel_angvel,
+                                 const edyn::quaternion &wheel_orn, edyn::scalar dt) {
+    auto spin_axis = edyn::quaternion_x(wheel_orn);
+    auto spin_speed = edyn::dot(wheel_angvel, spin_axis);
+    auto longitudinal_speed = edyn::length(edyn::project_direction(wheel_linvel, spin_axis));
+    auto control = WheelControl{};
+
+    // Rudimentary traction control.
+    edyn::scalar throttle;
+
+    if (std::abs(spin_speed) * 0.25f > longitudinal_speed) {
+        throttle = 0;
+    } else {
+        throttle = state.throttle;
+    }
 
-        if (throttle > 0) {
-            auto wheel_entity = vehicle.wheel_entity[i];
-            auto &wheel_orn = registry.get<edyn::orientation>(wheel_entity);
-            auto spin_axis = edyn::quaternion_x(wheel_orn);
+    if (throttle > 0) {
+        auto driving_torque = throttle * settings.driving_torque * spin_axis;
+        control.torque_impulse = driving_torque * dt;
+    }
 
-            auto driving_torque = throttle * settings.driving_torque * spin_axis;
-            edyn::rigidbody_apply_torque_impulse(registry, vehicle.wheel_entity[i], driving_torque * dt);
-        }
+    // Rudimentary ABS.
+    edyn::scalar brakes;
+
+    if (longitudinal_speed > 2 &&
+        std::abs(spin_speed) < edyn::to_radians(1))
+    {
+        brakes = 0;
+    } else {
+        brakes = state.brakes;
     }
+
+    control.friction_torque = brakes * settings.brake_torque + settings.bearing_torque;
+
+    return control;
 }
 
-void ApplyBrakes(entt::registry &registry, const Vehicle &vehicle,
-                 const VehicleSettings &settings, const VehicleState &state, edyn::scalar dt) {
+void ApplyWheelControls(entt::registry &registry, const Vehicle &vehicle,
+                        const VehicleSettings &settings, const VehicleState &state, edyn::scalar dt) {
     for (int i = 0; i < 4; ++i) {
         auto wheel_entity = vehicle.wheel_entity[i];
         auto &wheel_linvel = registry.get<edyn::linvel>(wheel_entity);
         auto &wheel_angvel = registry.get<edyn::angvel>(wheel_entity);
         auto &wheel_orn = registry.get<edyn::orientation>(wheel_entity);
-        auto spin_axis = edyn::quaternion_x(wheel_orn);
-        auto spin_speed = edyn::dot(wheel_angvel, spin_axis);
-        auto longitudinal_speed = edyn::length(edyn::project_direction(wheel_linvel, spin_axis));
-        edyn::scalar brakes;
-
-        // Rudimentary ABS.
-        if (longitudinal_speed > 2 &&
-            std::abs(spin_speed) < edyn::to_radians(1))
-        {
-            brakes = 0;
-        } else {
-            brakes = state.brakes;
+        auto control = ComputeWheelControl(settings, state, wheel_linvel, wheel_angvel, wheel_orn, dt);
+
+        if (control.torque_impulse != edyn::vector3_zero) {
+            edyn::rigidbody_apply_torque_impulse(registry, wheel_entity, control.torque_impulse);
         }
 
         auto &con = registry.get<edyn::generic_constraint>(vehicle.suspension_entity[i]);
-        con.angular_dofs[0].friction_torque = brakes * settings.brake_torque + settings.bearing_torque;
+        con.angular_dofs[0].friction_torque = control.friction_torque;
     }
 }
 
 void UpdateVehicles(entt::registry &registry) {
-    ProcessActions(registry);
+    ProcessVehicleActions(registry);
 
     auto dt = edyn::get_fixed_dt(registry);
     auto vehicle_view = registry.view<const Vehicle, const VehicleSettings, VehicleState>(edyn::exclude_sleeping_disabled);
 
     for (auto [entity, vehicle, settings, state] : vehicle_view.each()) {
         ApplySteering(registry, vehicle, settings, state, dt);
-        ApplyThrottle(registry, vehicle, settings, state, dt);
-        ApplyBrakes(registry, vehicle, settings, state, dt);
+        ApplyWheelControls(registry, vehicle, settings, state, dt);
         registry.patch<VehicleState>(entity);
     }
 }
@@ -0,0 +1,184 @@
+#include "world_snapshot.hpp"
+#include "shape_swap.hpp"
+#include <algorithm>
+#include <entt/entity/registry.hpp>
+#include <edyn/edyn.hpp>
+#include <edyn/networking/comp/entity_owner.hpp>
+
+static edyn::rigidbody_kind GetRigidBodyKind(entt::registry &registry, entt::entity entity) {
+    if (registry.all_of<edyn::dynamic_tag>(entity)) {
+        return edyn::rigidbody_kind::rb_dynamic;
+    } else if (registry.all_of<edyn::kinematic_tag>(entity)) {
+        return edyn::rigidbody_kind::rb_kinematic;
+    }
+
+    return edyn::rigidbody_kind::rb_static;
+}
+
+WorldSnapshot TakeWorldSnapshot(entt::registry &registry) {
+    auto snapshot = WorldSnapshot{};
+    auto shape_views_tuple = edyn::get_tuple_of_shape_views(registry);
+    auto body_view = registry.view<edyn::rigidbody_tag, edyn::position, edyn::orientation>(entt::exclude<edyn::entity_owner>);
+    auto vel_view = registry.view<edyn::linvel, edyn::angvel>();
+    auto mass_view = registry.view<edyn::mass, edyn::inertia>();
+    auto shape_view = registry.view<edyn::shape_index>();
+    auto material_view = registry.view<edyn::material>();
+
+    for (auto [entity, pos, orn] : body_view.each()) {
+        auto &body = snapshot.bodies.emplace_back();
+        body.entity = entity;
+        body.kind = GetRigidBodyKind(registry, entity);
+        body.position = pos;
+        body.orientation = orn;
+        body.linvel = edyn::vector3_zero;
+        body.angvel = edyn::vector3_zero;
+        body.mass = 0;
+        body.inertia = edyn::matrix3x3_zero;
+        body.shape = -1;
+        body.has_material = material_view.contains(entity);
+        body.networked = registry.all_of<edyn::networked_tag>(entity);
+        body.presentation = registry.all_of<edyn::present_position>(entity);
+
+        if (vel_view.contains(entity)) {
+            auto [linvel, angvel] = vel_view.get(entity);
+            body.linvel = linvel;
+            body.angvel = angvel;
+        }
+
+        if (mass_view.contains(entity)) {
+            auto [mass, inertia] = mass_view.get(entity);
+            body.mass = edyn::scalar(mass);
+            body.inertia = inertia;
+        }
+
+        if (body.has_material) {
+            body.material = material_view.get<edyn::material>(entity);
+        }
+
+        if (shape_view.contains(entity)) {
+            body.shape = static_cast<int32_t>(snapshot.shapes.size());
+            edyn::visit_shape(shape_view.get<edyn::shape_index>(entity), entity, shape_views_tuple, [&](auto &&shape) {
+                snapshot.shapes.emplace_back(shape);
+            });
+        }
+    }
+
+    return snapshot;
+}
+
+static edyn::rigidbody_def GetRigidBodyDef(const WorldSnapshot &snapshot, const WorldSnapshotBody &body) {
+    auto def = edyn::rigidbody_def{};
+    def.kind = body.kind;
+    def.position = body.position;
+    def.orientation = body.orientation;
+    def.linvel = body.linvel;
+    def.angvel = body.angvel;
+    def.networked = body.networked;
+    def.presentation = body.presentation;
+
+    if (body.kind == edyn::rigidbody_kind::rb_dynamic) {
+        def.mass = body.mass;
+        def.inertia = body.inertia;
+    }
+
+    if (body.shape >= 0) {
+        def.shape = snapshot.shapes[body.shape];
+    }
+
+    if (body.has_material) {
+        def.material = body.material;
+    } else {
+        def.material.reset();
+    }
+
+    return def;
+}
+
+void RestoreWorldSnapshot(entt::registry &registry, const WorldSnapshot &snapshot) {
+    auto snapshot_entities = std::vector<entt::entity>{};
+    snapshot_entities.reserve(snapshot.bodies.size());
+
+    for (auto &body : snapshot.bodies) {
+        snapshot_entities.push_back(body.entity);
+    }
+
+    std::sort(snapshot_entities.begin(), snapshot_entities.end());
+
+    // Destroy the bodies created after the snapshot first, which could
+    // otherwise hold the identifiers of the ones that have to be recreated.
+    // Bodies owned by clients, such as the ones they use to pick objects,
+    // are left alone.
+    auto body_view = registry.view<edyn::rigidbody_tag>(entt::exclude<edyn::entity_owner>);
+    auto created = std::vector<entt::entity>{};
+
+    for (auto entity : body_view) {
+        if (!std::binary_search(snapshot_entities.begin(), snapshot_entities.end(), entity)) {
+            created.push_back(entity);
+        }
+    }
+
+    registry.destroy(created.begin(), created.end());
+
+    auto shape_views_tuple = edyn::get_tuple_of_shape_views(registry);
+
+    for (auto &body : snapshot.bodies) {
+        if (!registry.valid(body.entity) || !body_view.contains(body.entity)) {
+            // Takes a new identifier if this one is in use, such as by a
+            // client body.
+            auto entity = registry.create(body.entity);
+            edyn::make_rigidbody(entity, registry, GetRigidBodyDef(snapshot, body));
+            continue;
+        }
+
+        auto entity = body.entity;
+
+        if (GetRigidBodyKind(registry, entity) != body.kind) {
+            edyn::rigidbody_set_kind(registry, entity, body.kind);
+        }
+
+        if (body.shape >= 0) {
+            // Only replace the shape if it was swapped for another one,
+            // since that's costly for polyhedrons.
+            auto &shape = snapshot.shapes[body.shape];
+            auto same_shape = false;
+
+            if (auto *sh_idx = registry.try_get<edyn::shape_index>(entity)) {
+                edyn::visit_shape(*sh_idx, entity, shape_views_tuple, [&](auto &&current) {
+                    same_shape = IsSameShape(current, shape);
+                });
+            }
+
+            if (!same_shape) {
+                edyn::rigidbody_set_shape(registry, entity, shape);
+            }
+        }
+
+        if (body.kind == edyn::rigidbody_kind::rb_dynamic) {
+            if (edyn::scalar(registry.get<edyn::mass>(entity)) != body.mass) {
+                edyn::set_rigidbody_mass(registry, entity, body.mass);
+            }
+
+            edyn::set_rigidbody_inertia(registry, entity, body.inertia);
+        }
+
+        if (body.has_material) {
+            registry.emplace_or_replace<edyn::material>(entity, body.material);
+        } else if (registry.all_of<edyn::material>(entity)) {
+            registry.remove<edyn::material>(entity);
+        }
+
+        // Replacing notifies Edyn of the changes, which are then propagated
+        // to the simulation.
+        registry.replace<edyn::position>(entity, body.position);
+        registry.replace<edyn::orientation>(entity, body.orientation);
+
+        if (registry.all_of<edyn::linvel, edyn::angvel>(entity)) {
+            registry.replace<edyn::linvel>(entity, body.linvel);
+            registry.replace<edyn::angvel>(entity, body.angvel);
+        }
+
+        if (body.kind == edyn::rigidbody_kind::rb_dynamic) {
+            edyn::wake_up_entity(registry, entity);
+        }
+    }
+}
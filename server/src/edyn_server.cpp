@@ -1,11 +1,11 @@
 #include "edyn_server.hpp"
+#include "async_log.hpp"
 #include <entt/entity/registry.hpp>
 #include <edyn/edyn.hpp>
 #include <edyn/networking/networking.hpp>
 #include <edyn/networking/sys/server_side.hpp>
 #include <enet/enet.h>
 #include <iostream>
-#include <iomanip>
 
 struct PeerID {
     unsigned short value;
@@ -128,7 +128,7 @@ void edyn_server_process_packets(entt::registry &registry) {
                 auto delay = edyn::packet::set_playout_delay{client.playout_delay};
                 send_edyn_packet_to_client(registry, client_entity, edyn::packet::edyn_packet{delay});
 
-                std::cout << "Connected " << std::hex << entt::to_integral(client_entity) << std::endl;
+                Log("Connected %x", unsigned(entt::to_integral(client_entity)));
                 break;
             }
 
@@ -136,7 +136,7 @@ void edyn_server_process_packets(entt::registry &registry) {
                 auto client_entity = client_entity_map.at(peerID);
                 edyn::server_destroy_client(registry, client_entity);
                 client_entity_map.erase(peerID);
-                std::cout << "Disconnected " << std::hex << entt::to_integral(client_entity) << std::endl;
+                Log("Disconnected %x", unsigned(entt::to_integral(client_entity)));
                 break;
             }
 
@@ -206,9 +206,8 @@ void edyn_server_run(entt::registry &registry) {
             data_outgoing_total_prev = host.totalSentData;
             data_incoming_total_prev = host.totalReceivedData;
 
-            std::cout << std::setiosflags(std::ios::fixed) << std::setprecision(3)
-                << "Network data rate(kB/s): up " << network_outgoing_data_rate
-                << " | down " << network_incoming_data_rate << std::endl;
+            Log("Network data rate(kB/s): up %.3f | down %.3f",
+                double(network_outgoing_data_rate), double(network_incoming_data_rate));
         }
 
         // Apply delay to maintain a fixed update rate.
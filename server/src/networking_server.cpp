@@ -2,9 +2,20 @@
 #include <edyn/util/rigidbody.hpp>
 #include <entt/entity/registry.hpp>
 #include <edyn/networking/networking.hpp>
+#include <edyn/time/time.hpp>
+#include "async_log.hpp"
 #include "pick_input.hpp"
 #include "edyn_server.hpp"
 #include "server_ports.hpp"
+#include "world_snapshot.hpp"
+
+// The map is restarted periodically by restoring the state it had right
+// after being created.
+struct MapRestart {
+    static constexpr double interval = 300;
+    WorldSnapshot snapshot;
+    double next_time;
+};
 
 void create_scene(entt::registry &registry) {
     // Create floor.
@@ -38,7 +49,16 @@ void create_scene(entt::registry &registry) {
     }
 }
 
-void edyn_server_update(entt::registry &registry) {}
+void edyn_server_update(entt::registry &registry) {
+    auto &restart = registry.ctx().get<MapRestart>();
+    auto time = edyn::performance_time();
+
+    if (time >= restart.next_time) {
+        RestoreWorldSnapshot(registry, restart.snapshot);
+        restart.next_time = time + MapRestart::interval;
+        Log("Map restarted");
+    }
+}
 
 int main() {
     entt::registry registry;
@@ -50,6 +70,7 @@ int main() {
     edyn::set_pre_step_callback(registry, &UpdatePickInput);
 
     create_scene(registry);
+    registry.ctx().emplace<MapRestart>(TakeWorldSnapshot(registry), edyn::performance_time() + MapRestart::interval);
 
     edyn_server_run(registry);
 
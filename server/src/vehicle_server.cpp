@@ -9,11 +9,14 @@
 #include <edyn/edyn.hpp>
 #include <edyn/networking/networking.hpp>
 #include "vehicle_system.hpp"
+#include "raycast_vehicle_system.hpp"
 #include "edyn_server.hpp"
 #include "pick_input.hpp"
 #include "server_ports.hpp"
 
 std::vector<entt::entity> g_pending_new_clients;
+// Clients alternate between the multi-body and the raycast vehicle.
+unsigned g_num_clients {0};
 
 void create_scene(entt::registry &registry) {
     // Create floor.
@@ -31,9 +34,8 @@ void on_construct_remote_client(entt::registry &registry, entt::entity client_en
 }
 
 void assign_vehicle_ownership_to_client(entt::registry &registry,
-                                        entt::entity vehicle_entity,
+                                        const std::vector<entt::entity> &entities,
                                         entt::entity client_entity) {
-    auto entities = GetVehicleEntities(registry, vehicle_entity);
     auto &client = registry.get<edyn::remote_client>(client_entity);
     client.owned_entities.push(entities.begin(), entities.end());
 
@@ -44,9 +46,15 @@ void assign_vehicle_ownership_to_client(entt::registry &registry,
 
 void edyn_server_update(entt::registry &registry) {
     for (auto client_entity : g_pending_new_clients) {
-        auto vehicle_entity = CreateVehicle(registry);
-        auto asset_entity = MakeVehicleNetworked(registry, vehicle_entity);
-        assign_vehicle_ownership_to_client(registry, vehicle_entity, client_entity);
+        auto raycast = g_num_clients++ % 2 == 1;
+        auto vehicle_entity = raycast ? CreateRaycastVehicle(registry) : CreateVehicle(registry);
+        auto asset_entity = raycast ?
+            MakeRaycastVehicleNetworked(registry, vehicle_entity) :
+            MakeVehicleNetworked(registry, vehicle_entity);
+        auto entities = raycast ?
+            GetRaycastVehicleEntities(registry, vehicle_entity) :
+            GetVehicleEntities(registry, vehicle_entity);
+        assign_vehicle_ownership_to_client(registry, entities, client_entity);
 
         // Also assign ownership of asset.
         registry.emplace<edyn::entity_owner>(asset_entity, client_entity);
@@ -55,8 +63,10 @@ void edyn_server_update(entt::registry &registry) {
         // Make AABB of interest follow vehicle.
         registry.get<edyn::aabb_of_interest>(client_entity).aabb = {-50 * edyn::vector3_one, 50 * edyn::vector3_one};
 
-        auto &veh = registry.get<Vehicle>(vehicle_entity);
-        registry.emplace<edyn::aabb_oi_follow>(client_entity, veh.chassis_entity);
+        auto chassis_entity = raycast ?
+            registry.get<RaycastVehicle>(vehicle_entity).chassis_entity :
+            registry.get<Vehicle>(vehicle_entity).chassis_entity;
+        registry.emplace<edyn::aabb_oi_follow>(client_entity, chassis_entity);
     }
 
     g_pending_new_clients.clear();
@@ -64,7 +74,8 @@ void edyn_server_update(entt::registry &registry) {
 
 void PreStepUpdate(entt::registry &registry) {
     UpdatePickInput(registry);
-    UpdateVehicles(registry);
+    UpdateVehiclesBatched(registry);
+    UpdateRaycastVehicles(registry);
 }
 
 int main() {
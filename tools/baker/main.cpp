@@ -0,0 +1,290 @@
+#include "baked_asset.hpp"
+#include "mapped_page_loader.hpp"
+#include "obj_loader.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <edyn/math/math.hpp>
+#include <edyn/serialization/paged_triangle_mesh_s11n.hpp>
+#include <edyn/shapes/create_paged_triangle_mesh.hpp>
+#include <edyn/util/shape_io.hpp>
+
+// Converts the OBJ files in `resources/` into the baked assets the examples
+// load. Usage: EdynTestbedBaker [resources directory] [output directory].
+// Run from the repository root, the defaults write into `resources/baked/`.
+
+enum class BakeKind {
+    TriangleMesh,
+    PagedMesh,
+    Polyhedron,
+    Compound
+};
+
+struct BakeEntry {
+    std::string name;
+    std::string obj;
+    BakeKind kind;
+    edyn::vector3 position {edyn::vector3_zero};
+    edyn::quaternion orientation {edyn::quaternion_identity};
+    edyn::vector3 scale {edyn::vector3_one};
+    // Take per-vertex friction and restitution from the red and green
+    // channels of the vertex colors.
+    bool vertex_materials {false};
+};
+
+// Shapes are baked with the transforms the examples need since they can't
+// be transformed after the fact.
+static std::vector<BakeEntry> GetBakeManifest() {
+    return {
+        {"terrain", "terrain.obj", BakeKind::TriangleMesh,
+            edyn::vector3_zero, edyn::quaternion_identity, edyn::scalar(0.1) * edyn::vector3_one},
+        {"plane_per_vert", "plane_per_vert.obj", BakeKind::TriangleMesh,
+            edyn::vector3_zero, edyn::quaternion_axis_angle({1, 0, 0}, -edyn::half_pi), edyn::vector3_one, true},
+        {"terrain_large", "terrain_large.obj", BakeKind::PagedMesh},
+        {"box", "box.obj", BakeKind::Polyhedron},
+        {"box_stretched", "box.obj", BakeKind::Polyhedron,
+            edyn::vector3_zero, edyn::quaternion_identity, {1.5, 1.8, 2}},
+        {"box_subdiv", "box_subdiv.obj", BakeKind::Polyhedron},
+        {"cylinder", "cylinder.obj", BakeKind::Polyhedron},
+        {"rock", "rock.obj", BakeKind::Polyhedron},
+        {"rock_scaled", "rock.obj", BakeKind::Polyhedron,
+            edyn::vector3_zero, edyn::quaternion_identity, {0.8, 0.9, 1.1}},
+        {"rock_wide", "rock.obj", BakeKind::Polyhedron,
+            edyn::vector3_zero, edyn::quaternion_identity, {1.1, 0.9, 1.3}},
+        {"chain_link", "chain_link.obj", BakeKind::Compound},
+        {"chain_link_rotated", "chain_link.obj", BakeKind::Compound,
+            edyn::vector3_zero, edyn::quaternion_axis_angle({0, 1, 0}, edyn::pi * 0.5)},
+    };
+}
+
+// Runs the task on a few threads and waits. The baker doesn't set up an
+// Edyn task scheduler since it doesn't simulate anything.
+static void EnqueueTaskWait(edyn::task_delegate_t task, unsigned size) {
+    auto num_threads = std::min(size, std::max(std::thread::hardware_concurrency(), 1u));
+    auto threads = std::vector<std::thread>{};
+
+    for (unsigned i = 0; i < num_threads; ++i) {
+        auto start = size * i / num_threads;
+        auto end = size * (i + 1) / num_threads;
+        threads.emplace_back([task, start, end] { task(start, end); });
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+static bool BakeTriangleMesh(const BakeEntry &entry, const std::string &obj_path, const std::string &output_dir) {
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<uint32_t>{};
+    auto colors = std::vector<edyn::vector3>{};
+
+    if (!edyn::load_tri_mesh_from_obj(obj_path, vertices, indices,
+                                      entry.vertex_materials ? &colors : nullptr,
+                                      entry.position, entry.orientation, entry.scale)) {
+        return false;
+    }
+
+    auto trimesh = edyn::triangle_mesh{};
+    trimesh.insert_vertices(vertices.begin(), vertices.end());
+    trimesh.insert_indices(indices.begin(), indices.end());
+
+    if (entry.vertex_materials) {
+        if (colors.size() != vertices.size()) {
+            return false;
+        }
+
+        auto friction = std::vector<edyn::scalar>{};
+        auto restitution = std::vector<edyn::scalar>{};
+
+        for (auto color : colors) {
+            friction.push_back(color.x);
+            restitution.push_back(color.y);
+        }
+
+        trimesh.insert_friction_coefficients(friction.begin(), friction.end());
+        trimesh.insert_restitution_coefficients(restitution.begin(), restitution.end());
+    }
+
+    trimesh.initialize();
+
+    auto path = GetBakedAssetPath(entry.name, output_dir);
+    auto payload = std::vector<uint8_t>{};
+    return SaveBakedTriangleMesh(path, trimesh) &&
+           ReadBakedAsset(path, BakedAssetKind::TriangleMesh, payload);
+}
+
+// Whether a decoded page matches its source submesh, up to the truncation of
+// scalars. The edges must keep the convexity and normals calculated against
+// the full mesh, otherwise contacts near page borders change.
+static bool IsSameTriangleMesh(const edyn::triangle_mesh &decoded, const edyn::triangle_mesh &source) {
+    constexpr auto position_tolerance = edyn::scalar(0.01);
+    constexpr auto normal_tolerance = edyn::scalar(0.001);
+
+    if (decoded.num_vertices() != source.num_vertices() ||
+        decoded.num_edges() != source.num_edges() ||
+        decoded.num_triangles() != source.num_triangles()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < source.num_vertices(); ++i) {
+        auto &position = source.get_vertex_position(i);
+        auto tolerance = position_tolerance * std::max(edyn::length(position), edyn::scalar(1));
+
+        if (edyn::distance(decoded.get_vertex_position(i), position) > tolerance) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < source.num_edges(); ++i) {
+        if (decoded.get_edge_vertex_indices(i) != source.get_edge_vertex_indices(i) ||
+            decoded.is_convex_edge(i) != source.is_convex_edge(i) ||
+            decoded.is_boundary_edge(i) != source.is_boundary_edge(i)) {
+            return false;
+        }
+
+        auto decoded_normals = decoded.get_convex_edge_face_normals(i);
+        auto source_normals = source.get_convex_edge_face_normals(i);
+
+        for (size_t j = 0; j < source_normals.size(); ++j) {
+            if (edyn::distance(decoded_normals[j], source_normals[j]) > normal_tolerance) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool BakePagedMesh(const BakeEntry &entry, const std::string &obj_path, const std::string &output_dir) {
+    auto vertices = std::vector<edyn::vector3>{};
+    auto indices = std::vector<uint32_t>{};
+
+    if (!LoadTriMeshFromObj(obj_path, vertices, indices, &EnqueueTaskWait)) {
+        return false;
+    }
+
+    for (auto &v : vertices) {
+        v = edyn::to_world_space(v * entry.scale, entry.position, entry.orientation);
+    }
+
+    auto paged_trimesh = edyn::paged_triangle_mesh(std::make_shared<MappedPageLoader>());
+
+    // Splits the mesh into a bunch of smaller `triangle_mesh`.
+    edyn::create_paged_triangle_mesh(
+        paged_trimesh,
+        vertices.begin(), vertices.end(),
+        indices.begin(), indices.end(),
+        1 << 11, {}, {}, &EnqueueTaskWait);
+
+    auto structure_path = output_dir + entry.name + ".bin";
+    auto pages_path = output_dir + entry.name + ".pages";
+
+    {
+        auto output = edyn::paged_triangle_mesh_file_output_archive(structure_path,
+            edyn::paged_triangle_mesh_serialization_mode::external);
+        edyn::serialize(output, paged_trimesh);
+    }
+
+    if (!WriteMappedPageFile(pages_path, structure_path, paged_trimesh, PageCodec::Quantized)) {
+        return false;
+    }
+
+    // Validate by decoding every page back.
+    auto pages = MappedPageLoader{};
+
+    if (!pages.open(pages_path, structure_path) || pages.numPages() != paged_trimesh.number_of_submeshes()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < pages.numPages(); ++i) {
+        auto &page = pages.entry(i);
+        auto *data = pages.file().data() + page.offset;
+        auto trimesh = edyn::triangle_mesh{};
+
+        if (ComputeChecksum(data, page.size) != page.checksum ||
+            !DecodePage(data, page.size, trimesh) ||
+            !IsSameTriangleMesh(trimesh, *paged_trimesh.get_submesh(i))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool BakePolyhedron(const BakeEntry &entry, const std::string &obj_path, const std::string &output_dir) {
+    auto polyhedrons = edyn::load_convex_polyhedrons_from_obj(obj_path, entry.position, entry.orientation, entry.scale);
+
+    if (polyhedrons.empty()) {
+        return false;
+    }
+
+    auto path = GetBakedAssetPath(entry.name, output_dir);
+    auto payload = std::vector<uint8_t>{};
+    return SaveBakedPolyhedron(path, polyhedrons.front().shape) &&
+           ReadBakedAsset(path, BakedAssetKind::Polyhedron, payload);
+}
+
+static bool BakeCompound(const BakeEntry &entry, const std::string &obj_path, const std::string &output_dir) {
+    auto compound = edyn::load_compound_shape_from_obj(obj_path, entry.position, entry.orientation, entry.scale);
+
+    if (compound.nodes.empty()) {
+        return false;
+    }
+
+    auto path = GetBakedAssetPath(entry.name, output_dir);
+    auto payload = std::vector<uint8_t>{};
+    return SaveBakedCompound(path, compound) &&
+           ReadBakedAsset(path, BakedAssetKind::Compound, payload);
+}
+
+int main(int argc, char **argv) {
+    auto resources_dir = std::string(argc > 1 ? argv[1] : "resources");
+    auto output_dir = std::string(argc > 2 ? argv[2] : "resources/baked");
+
+    if (resources_dir.back() != '/') {
+        resources_dir += '/';
+    }
+
+    if (output_dir.back() != '/') {
+        output_dir += '/';
+    }
+
+    auto error = std::error_code{};
+    std::filesystem::create_directories(output_dir, error);
+
+    if (error) {
+        std::printf("Could not create %s: %s\n", output_dir.c_str(), error.message().c_str());
+        return 1;
+    }
+
+    auto num_failed = 0;
+
+    for (auto &entry : GetBakeManifest()) {
+        auto obj_path = resources_dir + entry.obj;
+        auto success = false;
+
+        switch (entry.kind) {
+        case BakeKind::TriangleMesh:
+            success = BakeTriangleMesh(entry, obj_path, output_dir);
+            break;
+        case BakeKind::PagedMesh:
+            success = BakePagedMesh(entry, obj_path, output_dir);
+            break;
+        case BakeKind::Polyhedron:
+            success = BakePolyhedron(entry, obj_path, output_dir);
+            break;
+        case BakeKind::Compound:
+            success = BakeCompound(entry, obj_path, output_dir);
+            break;
+        }
+
+        std::printf("%-20s %-20s %s\n", entry.name.c_str(), entry.obj.c_str(), success ? "ok" : "FAILED");
+        num_failed += !success;
+    }
+
+    return num_failed == 0 ? 0 : 1;
+}